@@ -13,6 +13,7 @@
 #include <set>
 #include <vector>
 
+#include "philox.hpp"
 #include "tp_args.hpp"
 
 std::random_device rd;
@@ -142,19 +143,127 @@ std::array<double, 2> operator-(const std::array<double, 2> a, const std::array<
     return a + (b * -1.0);
 }
 
-double count_cost(const problem_t& problem, const solution_t& solution)
+/*
+ * Tour length kernels, picked once at runtime (AVX-512, AVX2, SSE2, scalar).
+ * Every edge is computed as std::sqrt(dx*dx + dy*dy) without FMA, so single
+ * edges are bit-identical to the scalar code. Vector kernels sum per lane, so
+ * the total differs only by summation order:
+ *   |simd - scalar| <= n * DBL_EPSILON * length
+ * Coordinates are loaded as {x, y} pairs and shuffled into lanes; this was
+ * faster than hardware gathers.
+ */
+using tour_length_f = double (*)(const city_t* cities, const int* tour, int n);
+
+/// edges starting at positions i..n-1, including the closing edge
+double tour_length_range(const city_t* cities, const int* tour, int i, int n)
 {
     double length = 0.0;
-    for (int i = 0; i < solution.size(); i++) {
-        auto v = problem[solution[i]].coordinates - problem[solution[(i + 1) % solution.size()]].coordinates;
-        double l = 0;
-        for (auto& x : v)
-            l += x * x;
-        length += std::sqrt(l);
+    for (; i < n; i++) {
+        const auto& a = cities[tour[i]].coordinates;
+        const auto& b = cities[tour[(i + 1) % n]].coordinates;
+        double dx = a[0] - b[0];
+        double dy = a[1] - b[1];
+        length += std::sqrt(dx * dx + dy * dy);
     }
     return length;
 }
 
+double tour_length_scalar(const city_t* cities, const int* tour, int n)
+{
+    return tour_length_range(cities, tour, 0, n);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+__attribute__((target("sse2"))) double tour_length_sse2(const city_t* cities, const int* tour, int n)
+{
+    __m128d sum = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 2 < n; i += 2) {
+        __m128d a0 = _mm_loadu_pd(cities[tour[i]].coordinates.data());
+        __m128d a1 = _mm_loadu_pd(cities[tour[i + 1]].coordinates.data());
+        __m128d a2 = _mm_loadu_pd(cities[tour[i + 2]].coordinates.data());
+        __m128d d0 = _mm_sub_pd(a0, a1);
+        __m128d d1 = _mm_sub_pd(a1, a2);
+        __m128d dx = _mm_unpacklo_pd(d0, d1);
+        __m128d dy = _mm_unpackhi_pd(d0, d1);
+        sum = _mm_add_pd(sum, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + tour_length_range(cities, tour, i, n);
+}
+
+__attribute__((target("avx2"))) double tour_length_avx2(const city_t* cities, const int* tour, int n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 4 < n; i += 4) {
+        __m128d p[5];
+        for (int k = 0; k < 5; k++)
+            p[k] = _mm_loadu_pd(cities[tour[i + k]].coordinates.data());
+        __m256d from = _mm256_insertf128_pd(_mm256_castpd128_pd256(p[0]), p[2], 1);
+        __m256d mid = _mm256_insertf128_pd(_mm256_castpd128_pd256(p[1]), p[3], 1);
+        __m256d to = _mm256_insertf128_pd(_mm256_castpd128_pd256(p[2]), p[4], 1);
+        __m256d d0 = _mm256_sub_pd(from, mid);
+        __m256d d1 = _mm256_sub_pd(mid, to);
+        __m256d dx = _mm256_unpacklo_pd(d0, d1);
+        __m256d dy = _mm256_unpackhi_pd(d0, d1);
+        sum = _mm256_add_pd(sum, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, sum);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + tour_length_range(cities, tour, i, n);
+}
+
+__attribute__((target("avx512f"))) double tour_length_avx512(const city_t* cities, const int* tour, int n)
+{
+    __m512d sum = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 8 < n; i += 8) {
+        __m128d p[9];
+        for (int k = 0; k < 9; k++)
+            p[k] = _mm_loadu_pd(cities[tour[i + k]].coordinates.data());
+        // the maskz forms with the full mask compile to the plain instructions; the plain intrinsics of
+        // GCC 12 start from _mm512_undefined_pd, which -Wmaybe-uninitialized reports
+        __m512d from = _mm512_maskz_insertf64x4(0xFF, _mm512_castpd256_pd512(_mm256_set_m128d(p[2], p[0])), _mm256_set_m128d(p[6], p[4]), 1);
+        __m512d mid = _mm512_maskz_insertf64x4(0xFF, _mm512_castpd256_pd512(_mm256_set_m128d(p[3], p[1])), _mm256_set_m128d(p[7], p[5]), 1);
+        __m512d to = _mm512_maskz_insertf64x4(0xFF, _mm512_castpd256_pd512(_mm256_set_m128d(p[4], p[2])), _mm256_set_m128d(p[8], p[6]), 1);
+        __m512d d0 = _mm512_sub_pd(from, mid);
+        __m512d d1 = _mm512_sub_pd(mid, to);
+        __m512d dx = _mm512_maskz_unpacklo_pd(0xFF, d0, d1);
+        __m512d dy = _mm512_maskz_unpackhi_pd(0xFF, d0, d1);
+        sum = _mm512_add_pd(sum, _mm512_maskz_sqrt_pd(0xFF, _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy))));
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, sum);
+    return (((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])))
+        + tour_length_range(cities, tour, i, n);
+}
+
+tour_length_f select_tour_length()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return tour_length_avx512;
+    if (__builtin_cpu_supports("avx2")) return tour_length_avx2;
+    if (__builtin_cpu_supports("sse2")) return tour_length_sse2;
+    return tour_length_scalar;
+}
+#else
+tour_length_f select_tour_length()
+{
+    return tour_length_scalar;
+}
+#endif
+
+double count_cost(const problem_t& problem, const solution_t& solution)
+{
+    static const tour_length_f tour_length = select_tour_length();
+    if (solution.empty()) return 0.0;
+    return tour_length(problem.data(), solution.data(), solution.size());
+}
+
 double fitness(const solution_t solution)
 {
     return std::max(1.0, 100 - count_cost(*solution.problem_p, solution));
@@ -162,25 +271,29 @@ double fitness(const solution_t solution)
     //    return 1.0 / (1.0 + count_cost(*solution.problem_p, solution));
 }
 
-solution_t mutation(const solution_t& solution)
+solution_t mutation(const solution_t& solution, philox_t& rng)
 {
     std::uniform_int_distribution<int> distr(0, solution.size() - 1);
-    int a(distr(rd_generator)), b(distr(rd_generator));
+    int a(distr(rng)), b(distr(rng));
     auto ret = solution;
     std::swap(ret[a], ret[b]);
     return ret;
 }
 
-std::vector<solution_t> crossover(const std::vector<solution_t>& solutions)
+std::vector<solution_t> crossover(const std::vector<solution_t>& solutions, philox_t& rng)
 {
     using namespace std;
     std::vector<solution_t> offspring = solutions;
     uniform_int_distribution<int> distr(0, solutions[0].size() - 1);
-    int cuts[2] = {distr(rd_generator), distr(rd_generator)};
+    int cuts[2] = {distr(rng), distr(rng)};
     if (cuts[0] == cuts[1]) return solutions;
     if (cuts[0] > cuts[1]) swap(cuts[0], cuts[1]);
 
-    map<int, int> taken_cities[2];
+    // mapping of the cities from the swapped segment, indexed by the city, -1 when not mapped;
+    // every thread keeps its own arrays, so there is no allocation after the first call
+    thread_local std::vector<int> taken_cities[2];
+    for (auto& t : taken_cities)
+        if (t.size() != solutions[0].size()) t.assign(solutions[0].size(), -1);
 
     for (int i = cuts[0]; i < cuts[1]; i++) {
         swap(offspring[0][i], offspring[1][i]);
@@ -193,10 +306,14 @@ std::vector<solution_t> crossover(const std::vector<solution_t>& solutions)
                 i = cuts[1] - 1;
                 continue;
             }
-            while (taken_cities[v].count(offspring[v][i])) {
-                offspring[v][i] = taken_cities[v].at(offspring[v][i]);
+            while (taken_cities[v][offspring[v][i]] >= 0) {
+                offspring[v][i] = taken_cities[v][offspring[v][i]];
             }
         }
+    for (int i = cuts[0]; i < cuts[1]; i++) {
+        taken_cities[0][offspring[0][i]] = -1;
+        taken_cities[1][offspring[1][i]] = -1;
+    }
     return offspring;
 }
 
@@ -237,41 +354,124 @@ std::vector<int> selection_tournament(std::vector<double> pop_fit)
     return ret;
 }
 
+/**
+ * @brief Roulette wheel built once per generation.
+ *
+ * It keeps the prefix sums of the fitnesses, so every draw is a binary search, O(log n),
+ * instead of a walk over the population. The wheel does not change after it is built,
+ * so threads can share it as long as each of them draws with its own generator.
+ */
+struct roulette_wheel_t {
+    std::vector<double> prefix;
+
+    roulette_wheel_t(const std::vector<double>& pop_fit) : prefix(pop_fit.size())
+    {
+        std::partial_sum(pop_fit.begin(), pop_fit.end(), prefix.begin());
+    }
+    double sum() const { return prefix.empty() ? 0.0 : prefix.back(); }
+    /// index of the individual that covers the point n from [0, sum())
+    int pick(double n) const
+    {
+        int picked = std::lower_bound(prefix.begin(), prefix.end(), n) - prefix.begin();
+        return std::min(picked, (int)prefix.size() - 1);
+    }
+    template <class RNG>
+    int operator()(RNG& rng) const
+    {
+        return pick(std::uniform_real_distribution<double>(0.0, sum())(rng));
+    }
+};
+
 std::vector<int> selection_roulette(std::vector<double> pop_fit)
 {
-    double sum_fit = std::accumulate(pop_fit.begin(), pop_fit.end(), 0.0);
-    std::vector<int> selected;
-    for (int i = 0; i < pop_fit.size(); i++) {
-        double n = std::uniform_real_distribution<double>(0.0, sum_fit)(rd_generator);
-        int picked = 0;
-        for (double s = 0.0; (s < n) && (picked < pop_fit.size() - 1);) {
-            s += pop_fit.at(picked);
-            if (s >= n) break;
+    roulette_wheel_t wheel(pop_fit);
+    std::vector<int> selected(pop_fit.size());
+    for (auto& e : selected)
+        e = wheel(rd_generator);
+    return selected;
+}
+
+/**
+ * @brief Stochastic universal sampling.
+ *
+ * The wheel is spun once and the individuals are picked by equally spaced pointers, so
+ * the number of copies of every individual is as close to its expected value as possible.
+ * It is a single pass over the prefix sums. The picks come out sorted, so they are shuffled
+ * before they are paired for the crossover.
+ */
+std::vector<int> selection_sus(std::vector<double> pop_fit)
+{
+    roulette_wheel_t wheel(pop_fit);
+    int n = pop_fit.size();
+    double step = wheel.sum() / n;
+    double start = std::uniform_real_distribution<double>(0.0, step)(rd_generator);
+    std::vector<int> selected(n);
+    int picked = 0;
+    for (int i = 0; i < n; i++) {
+        double pointer = start + i * step;
+        while ((picked < n - 1) && (wheel.prefix[picked] < pointer))
             picked++;
-        }
-        selected.push_back(picked);
+        selected[i] = picked;
     }
+    std::shuffle(selected.begin(), selected.end(), rd_generator);
     return selected;
 }
 
+/**
+ * @brief Indices of the k best individuals, the best first.
+ *
+ * nth_element finds them in O(n), only the k elites are sorted.
+ */
+std::vector<int> top_k(const std::vector<double>& pop_fit, int k)
+{
+    std::vector<int> idx(pop_fit.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    k = std::min(k, (int)idx.size());
+    auto better = [&pop_fit](int a, int b) { return pop_fit[a] > pop_fit[b]; };
+    std::nth_element(idx.begin(), idx.begin() + k, idx.end(), better);
+    idx.resize(k);
+    std::sort(idx.begin(), idx.end(), better);
+    return idx;
+}
+
+/**
+ * @brief Indices of all the individuals from the best, the fitness is computed once for each of them.
+ */
+std::vector<int> order_by_fitness(const std::vector<double>& pop_fit)
+{
+    std::vector<int> order(pop_fit.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&pop_fit](int a, int b) { return pop_fit[a] > pop_fit[b]; });
+    return order;
+}
+
 std::function<std::vector<int>(std::vector<double>)> selection_elite_factory(std::function<std::vector<int>(std::vector<double>)> orig_selection, int n)
 {
     return [=](std::vector<double> pop) -> std::vector<int> {
-        std::vector<std::pair<int, double>> idx_fitness;
-        int i = 0;
-        std::transform(pop.begin(), pop.end(), std::back_inserter(idx_fitness), [&i](auto e) {
-            std::pair<int, double> p = {i++, e};
-            return p;
-        });
-        std::sort(idx_fitness.begin(), idx_fitness.end(), [](auto a, auto b) { return a.second > b.second; });
+        auto elite = top_k(pop, n);
         auto ret = orig_selection(pop);
-        for (int i = 0; i < n; i++) {
-            ret.at(i) = idx_fitness.at(i).first;
+        for (int i = 0; i < elite.size(); i++) {
+            ret.at(i) = elite[i];
         }
         return ret;
     };
 }
 
+/**
+ * @brief The population sorted from the best, the fitness is computed once for each individual.
+ */
+template <typename SOLUTION>
+std::vector<SOLUTION> sorted_by_fitness(const std::vector<SOLUTION>& population)
+{
+    std::vector<double> pop_fit(population.size());
+    std::transform(population.begin(), population.end(), pop_fit.begin(), fitness);
+    std::vector<SOLUTION> sorted;
+    sorted.reserve(population.size());
+    for (int i : order_by_fitness(pop_fit))
+        sorted.push_back(population[i]);
+    return sorted;
+}
+
 
 auto print_population = [](auto results, int limit = 10) {
     for (auto e : results) {
@@ -288,13 +488,13 @@ auto print_population = [](auto results, int limit = 10) {
  * @return std::vector<solution_t> 
  */
 template <typename PROBLEM = problem_t, typename SOLUTION = solution_t>
-std::vector<SOLUTION> genetic_algorithm(PROBLEM problem, int pop_size, int iterations, double p_crossover, double p_mutation, const std::function<std::vector<int>(std::vector<double>)> selection)
+std::vector<SOLUTION> genetic_algorithm(PROBLEM problem, int pop_size, int iterations, double p_crossover, double p_mutation, const std::function<std::vector<int>(std::vector<double>)> selection, unsigned long seed)
 {
+    rd_generator.seed(seed);
     std::vector<SOLUTION> initial_population(pop_size);
     std::generate(initial_population.begin(), initial_population.end(), [&]() { return random_solution_for_problem(problem); });
 
-    std::vector<SOLUTION> population = initial_population;
-    std::sort(population.begin(), population.end(), [](auto a, auto b) { return fitness(a) > fitness(b); });
+    std::vector<SOLUTION> population = sorted_by_fitness(initial_population);
     //print_population(population);
     for (int iteration = 0; iteration < iterations; iteration++) {
         std::vector<double> fitnesses(pop_size);
@@ -307,15 +507,17 @@ std::vector<SOLUTION> genetic_algorithm(PROBLEM problem, int pop_size, int itera
 
 #pragma omp parallel for
         for (int i = 0; i < (pop_size - 1); i += 2) {
+            // every pair has its own stream, so the result does not depend on the threads
+            philox_t rng(seed, iteration, i);
             std::uniform_real_distribution<double> distr(0.0, 1.0);
             std::vector<SOLUTION> c = {population.at(selected.at(i)),
                 population.at(selected.at(i + 1))};
-            if (distr(rd_generator) > p_crossover) {
-                c = crossover(c);
+            if (distr(rng) > p_crossover) {
+                c = crossover(c, rng);
             }
             for (auto& e : c) {
-                if (distr(rd_generator) > p_mutation)
-                    e = mutation(e);
+                if (distr(rng) > p_mutation)
+                    e = mutation(e, rng);
             }
             //#pragma omp critical
             // {
@@ -328,7 +530,7 @@ std::vector<SOLUTION> genetic_algorithm(PROBLEM problem, int pop_size, int itera
         population = new_population;
     }
     std::cout << std::endl;
-    std::sort(population.begin(), population.end(), [](auto a, auto b) { return fitness(a) > fitness(b); });
+    population = sorted_by_fitness(population);
     //print_population(population);
     return population;
 }
@@ -340,8 +542,10 @@ int main(int argc, char** argv)
     std::map<std::string, std::function<std::vector<int>(std::vector<double>)>> selections;
     selections["tournament"] = selection_tournament;
     selections["roulette"] = selection_roulette;
+    selections["sus"] = selection_sus;
     selections["elite_2_tournament"] = selection_elite_factory(selection_tournament, 2);
     selections["elite_2_roulette"] = selection_elite_factory(selection_roulette, 2);
+    selections["elite_2_sus"] = selection_elite_factory(selection_sus, 2);
 
     auto help = arg(argc, argv, "help", false);
     std::string selections_list = "Available seletcions";
@@ -351,6 +555,7 @@ int main(int argc, char** argv)
 
     auto pop_size = arg(argc, argv, "pop_size", 2000, "Population size");
     auto iterations = arg(argc, argv, "iterations", 200, "Iterations count");
+    auto seed = arg(argc, argv, "seed", (unsigned long)rd(), "Random seed, the same seed gives the same result for any number of threads");
 
     if (help) {
         std::cout << "Genetic algorithm" << std::endl;
@@ -359,7 +564,7 @@ int main(int argc, char** argv)
     }
 
     problem_t problem = load_problem("cities1.txt");
-    std::vector<solution_t> results = genetic_algorithm<>(problem, pop_size, iterations, 0.1, 0.001, selections.at(selection));
+    std::vector<solution_t> results = genetic_algorithm<>(problem, pop_size, iterations, 0.1, 0.001, selections.at(selection), seed);
     std::ofstream result_route_file("route.gpx");
     result_route_file << results.at(0) << std::endl;
     return 0;
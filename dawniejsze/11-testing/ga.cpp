@@ -13,6 +13,8 @@
 #include <set>
 #include <vector>
 
+#include "philox.hpp"
+#include "statistics.hpp"
 #include "tp_args.hpp"
 
 std::random_device rd;
@@ -29,6 +31,12 @@ struct config_t {
     bool print_convergence_curve;
     bool print_population_fit;
     std::string result_filename;
+    unsigned long seed;
+    int elite_archive;
+    /// the diversity is computed only when stop_diversity is not negative
+    double stop_diversity;
+    /// empty when the algorithm runs all the iterations
+    termination_f stop;
 };
 
 
@@ -38,26 +46,19 @@ struct statistics_t {
     double mean;
     double stddev;
 
-    void calc_stats(std::vector<double> population_fitnesses)
+    void calc_stats(const std::vector<double>& population_fitnesses)
     {
-        if (population_fitnesses.size() < 2) {
-            max = population_fitnesses.at(0);
-            mean = population_fitnesses.at(0);
-            stddev = 0;
-            min = population_fitnesses.at(0);
-        } else {
-            double sum = std::accumulate(population_fitnesses.begin(), population_fitnesses.end(), 0.0);
-            max = *std::max_element(population_fitnesses.begin(), population_fitnesses.end());
-            min = *std::min_element(population_fitnesses.begin(), population_fitnesses.end());
-            mean = sum / (double)population_fitnesses.size();
-
-            std::vector<double> diff(population_fitnesses.size());
-            std::transform(population_fitnesses.begin(), population_fitnesses.end(),
-                diff.begin(), [this](double x) { return (x - mean) * (x - mean); });
-            double sq_sum = std::accumulate(diff.begin(), diff.end(), 0.0);
-
-            stddev = std::sqrt(sq_sum / (population_fitnesses.size() - 1));
-        }
+        running_stats_t stats;
+        for (auto f : population_fitnesses)
+            stats.add(f);
+        set(stats);
+    }
+    void set(const running_stats_t& stats)
+    {
+        max = stats.max;
+        min = stats.min;
+        mean = stats.mean;
+        stddev = stats.stddev();
     }
 };
 std::ostream& operator<<(std::ostream& o, const statistics_t& s)
@@ -190,43 +191,293 @@ std::array<double, 2> operator-(const std::array<double, 2> a, const std::array<
     return a + (b * -1.0);
 }
 
-double count_cost(const problem_t& problem, const solution_t& solution)
+/*
+ * Tour length kernels, picked once at runtime (AVX-512, AVX2, SSE2, scalar).
+ * Every edge is computed as std::sqrt(dx*dx + dy*dy) without FMA, so single
+ * edges are bit-identical to the scalar code. Vector kernels sum per lane, so
+ * the total differs only by summation order:
+ *   |simd - scalar| <= n * DBL_EPSILON * length
+ * Coordinates are loaded as {x, y} pairs and shuffled into lanes; this was
+ * faster than hardware gathers.
+ */
+using tour_length_f = double (*)(const city_t* cities, const int* tour, int n);
+
+/// edges starting at positions i..n-1, including the closing edge
+double tour_length_range(const city_t* cities, const int* tour, int i, int n)
 {
     double length = 0.0;
-    for (int i = 0; i < solution.size(); i++) {
-        auto v = problem[solution[i]].coordinates - problem[solution[(i + 1) % solution.size()]].coordinates;
-        double l = 0;
-        for (auto& x : v)
-            l += x * x;
-        length += std::sqrt(l);
+    for (; i < n; i++) {
+        const auto& a = cities[tour[i]].coordinates;
+        const auto& b = cities[tour[(i + 1) % n]].coordinates;
+        double dx = a[0] - b[0];
+        double dy = a[1] - b[1];
+        length += std::sqrt(dx * dx + dy * dy);
     }
     return length;
 }
 
+double tour_length_scalar(const city_t* cities, const int* tour, int n)
+{
+    return tour_length_range(cities, tour, 0, n);
+}
+
+/*
+ * Lengths of count tours stored row after row in tours. The tours are walked
+ * in lockstep (one lane per tour), so the lookups of the different tours do
+ * not wait for each other. Every lane sums its edges in the same order as
+ * tour_length_scalar, so the results are bit-identical to it.
+ */
+using tour_lengths_f = void (*)(const city_t* cities, const int* tours, int n, int count, double* out);
+
+void tour_lengths_scalar(const city_t* cities, const int* tours, int n, int count, double* out)
+{
+    constexpr int lanes = 4;
+    int t = 0;
+    for (; t + lanes <= count; t += lanes) {
+        const int* row = tours + std::size_t(t) * n;
+        double sum[lanes] = {};
+        for (int i = 0; i < n; i++) {
+            int j = (i + 1 == n) ? 0 : i + 1;
+            for (int k = 0; k < lanes; k++) {
+                const auto& a = cities[row[k * n + i]].coordinates;
+                const auto& b = cities[row[k * n + j]].coordinates;
+                double dx = a[0] - b[0];
+                double dy = a[1] - b[1];
+                sum[k] += std::sqrt(dx * dx + dy * dy);
+            }
+        }
+        std::copy(sum, sum + lanes, out + t);
+    }
+    for (; t < count; t++)
+        out[t] = tour_length_range(cities, tours + std::size_t(t) * n, 0, n);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+__attribute__((target("sse2"))) double tour_length_sse2(const city_t* cities, const int* tour, int n)
+{
+    __m128d sum = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 2 < n; i += 2) {
+        __m128d a0 = _mm_loadu_pd(cities[tour[i]].coordinates.data());
+        __m128d a1 = _mm_loadu_pd(cities[tour[i + 1]].coordinates.data());
+        __m128d a2 = _mm_loadu_pd(cities[tour[i + 2]].coordinates.data());
+        __m128d d0 = _mm_sub_pd(a0, a1);
+        __m128d d1 = _mm_sub_pd(a1, a2);
+        __m128d dx = _mm_unpacklo_pd(d0, d1);
+        __m128d dy = _mm_unpackhi_pd(d0, d1);
+        sum = _mm_add_pd(sum, _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy))));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, sum);
+    return (lanes[0] + lanes[1]) + tour_length_range(cities, tour, i, n);
+}
+
+__attribute__((target("avx2"))) double tour_length_avx2(const city_t* cities, const int* tour, int n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 4 < n; i += 4) {
+        __m128d p[5];
+        for (int k = 0; k < 5; k++)
+            p[k] = _mm_loadu_pd(cities[tour[i + k]].coordinates.data());
+        __m256d from = _mm256_insertf128_pd(_mm256_castpd128_pd256(p[0]), p[2], 1);
+        __m256d mid = _mm256_insertf128_pd(_mm256_castpd128_pd256(p[1]), p[3], 1);
+        __m256d to = _mm256_insertf128_pd(_mm256_castpd128_pd256(p[2]), p[4], 1);
+        __m256d d0 = _mm256_sub_pd(from, mid);
+        __m256d d1 = _mm256_sub_pd(mid, to);
+        __m256d dx = _mm256_unpacklo_pd(d0, d1);
+        __m256d dy = _mm256_unpackhi_pd(d0, d1);
+        sum = _mm256_add_pd(sum, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, sum);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + tour_length_range(cities, tour, i, n);
+}
+
+__attribute__((target("avx512f"))) double tour_length_avx512(const city_t* cities, const int* tour, int n)
+{
+    __m512d sum = _mm512_setzero_pd();
+    int i = 0;
+    for (; i + 8 < n; i += 8) {
+        __m128d p[9];
+        for (int k = 0; k < 9; k++)
+            p[k] = _mm_loadu_pd(cities[tour[i + k]].coordinates.data());
+        // the maskz forms with the full mask compile to the plain instructions; the plain intrinsics of
+        // GCC 12 start from _mm512_undefined_pd, which -Wmaybe-uninitialized reports
+        __m512d from = _mm512_maskz_insertf64x4(0xFF, _mm512_castpd256_pd512(_mm256_set_m128d(p[2], p[0])), _mm256_set_m128d(p[6], p[4]), 1);
+        __m512d mid = _mm512_maskz_insertf64x4(0xFF, _mm512_castpd256_pd512(_mm256_set_m128d(p[3], p[1])), _mm256_set_m128d(p[7], p[5]), 1);
+        __m512d to = _mm512_maskz_insertf64x4(0xFF, _mm512_castpd256_pd512(_mm256_set_m128d(p[4], p[2])), _mm256_set_m128d(p[8], p[6]), 1);
+        __m512d d0 = _mm512_sub_pd(from, mid);
+        __m512d d1 = _mm512_sub_pd(mid, to);
+        __m512d dx = _mm512_maskz_unpacklo_pd(0xFF, d0, d1);
+        __m512d dy = _mm512_maskz_unpackhi_pd(0xFF, d0, d1);
+        sum = _mm512_add_pd(sum, _mm512_maskz_sqrt_pd(0xFF, _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy))));
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, sum);
+    return (((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7])))
+        + tour_length_range(cities, tour, i, n);
+}
+
+/// {x, y} of city a in the low half and of city b in the high half
+__attribute__((target("avx2"))) inline __m256d load_city_pair(const city_t* cities, int a, int b)
+{
+    return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(cities[a].coordinates.data())),
+        _mm_loadu_pd(cities[b].coordinates.data()), 1);
+}
+
+__attribute__((target("avx2"))) void tour_lengths_avx2(const city_t* cities, const int* tours, int n, int count, double* out)
+{
+    int t = 0;
+    for (; n > 0 && t + 4 <= count; t += 4) {
+        const int* r0 = tours + std::size_t(t) * n;
+        const int* r1 = r0 + n;
+        const int* r2 = r1 + n;
+        const int* r3 = r2 + n;
+        __m256d q02 = load_city_pair(cities, r0[0], r2[0]);
+        __m256d q13 = load_city_pair(cities, r1[0], r3[0]);
+        __m256d sum = _mm256_setzero_pd();
+        for (int i = 1; i <= n; i++) {
+            int j = (i == n) ? 0 : i;
+            __m256d p02 = load_city_pair(cities, r0[j], r2[j]);
+            __m256d p13 = load_city_pair(cities, r1[j], r3[j]);
+            __m256d d02 = _mm256_sub_pd(q02, p02);
+            __m256d d13 = _mm256_sub_pd(q13, p13);
+            // tours t and t + 2 are in d02, t + 1 and t + 3 in d13, unpack gives lane k = tour t + k
+            __m256d dx = _mm256_unpacklo_pd(d02, d13);
+            __m256d dy = _mm256_unpackhi_pd(d02, d13);
+            sum = _mm256_add_pd(sum, _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy))));
+            q02 = p02;
+            q13 = p13;
+        }
+        _mm256_storeu_pd(out + t, sum);
+    }
+    for (; t < count; t++)
+        out[t] = tour_length_range(cities, tours + std::size_t(t) * n, 0, n);
+}
+
+tour_length_f select_tour_length()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return tour_length_avx512;
+    if (__builtin_cpu_supports("avx2")) return tour_length_avx2;
+    if (__builtin_cpu_supports("sse2")) return tour_length_sse2;
+    return tour_length_scalar;
+}
+
+tour_lengths_f select_tour_lengths()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return tour_lengths_avx2;
+    return tour_lengths_scalar;
+}
+#else
+tour_length_f select_tour_length()
+{
+    return tour_length_scalar;
+}
+
+tour_lengths_f select_tour_lengths()
+{
+    return tour_lengths_scalar;
+}
+#endif
+
+double count_cost(const problem_t& problem, const solution_t& solution)
+{
+    static const tour_length_f tour_length = select_tour_length();
+    if (solution.empty()) return 0.0;
+    return tour_length(problem.data(), solution.data(), solution.size());
+}
+
 double fitness(const solution_t solution)
 {
     return std::max(1.0, 100 - count_cost(*solution.problem_p, solution));
 }
 
-solution_t mutation(const solution_t& solution)
+/**
+ * @brief The chromosomes of the whole population in one row-major matrix.
+ *
+ * Row i holds the tour of individual i, so the population is a single
+ * allocation and evaluate_all can walk many tours at once.
+ */
+struct population_t {
+    std::shared_ptr<problem_t> problem_p;
+    int cities = 0;
+    std::vector<int> genes;
+
+    population_t(std::shared_ptr<problem_t> problem, int count)
+        : problem_p(problem), cities(problem->size()), genes(std::size_t(count) * problem->size())
+    {
+    }
+
+    int size() const { return cities ? genes.size() / cities : 0; }
+    int* operator[](int i) { return genes.data() + std::size_t(i) * cities; }
+    const int* operator[](int i) const { return genes.data() + std::size_t(i) * cities; }
+
+    solution_t get(int i) const
+    {
+        solution_t solution;
+        solution.problem_p = problem_p;
+        solution.assign((*this)[i], (*this)[i] + cities);
+        return solution;
+    }
+    void set(int i, const solution_t& solution)
+    {
+        std::copy(solution.begin(), solution.end(), (*this)[i]);
+    }
+};
+
+/**
+ * @brief Fitness of every individual.
+ *
+ * The tour lengths are summed in the order of tour_length_scalar. fitness() goes
+ * through count_cost, whose vector kernels sum per lane, so the two can differ by
+ * up to n * DBL_EPSILON * length and may order near-ties differently. Compare
+ * individuals by the values of one of them only.
+ *
+ * The values are also added to stats, if given, as they are computed.
+ */
+void evaluate_all(const population_t& population, std::vector<double>& out_fitness, running_stats_t* stats = nullptr)
+{
+    static const tour_lengths_f tour_lengths = select_tour_lengths();
+    constexpr int block = 64;
+    int count = population.size();
+    out_fitness.resize(count);
+#pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < count; t += block)
+        tour_lengths(population.problem_p->data(), population[t], population.cities, std::min(block, count - t), out_fitness.data() + t);
+    for (auto& f : out_fitness) {
+        f = std::max(1.0, 100 - f);
+        if (stats) stats->add(f);
+    }
+}
+
+solution_t mutation(const solution_t& solution, philox_t& rng)
 {
     std::uniform_int_distribution<int> distr(0, solution.size() - 1);
-    int a(distr(rd_generator)), b(distr(rd_generator));
+    int a(distr(rng)), b(distr(rng));
     auto ret = solution;
     std::swap(ret[a], ret[b]);
     return ret;
 }
 
-std::vector<solution_t> crossover(const std::vector<solution_t>& solutions)
+std::vector<solution_t> crossover(const std::vector<solution_t>& solutions, philox_t& rng)
 {
     using namespace std;
     std::vector<solution_t> offspring = solutions;
     uniform_int_distribution<int> distr(0, solutions[0].size() - 1);
-    int cuts[2] = {distr(rd_generator), distr(rd_generator)};
+    int cuts[2] = {distr(rng), distr(rng)};
     if (cuts[0] == cuts[1]) return solutions;
     if (cuts[0] > cuts[1]) swap(cuts[0], cuts[1]);
 
-    map<int, int> taken_cities[2];
+    // mapping of the cities from the swapped segment, indexed by the city, -1 when not mapped;
+    // every thread keeps its own arrays, so there is no allocation after the first call
+    thread_local std::vector<int> taken_cities[2];
+    for (auto& t : taken_cities)
+        if (t.size() != solutions[0].size()) t.assign(solutions[0].size(), -1);
 
     for (int i = cuts[0]; i < cuts[1]; i++) {
         swap(offspring[0][i], offspring[1][i]);
@@ -239,10 +490,14 @@ std::vector<solution_t> crossover(const std::vector<solution_t>& solutions)
                 i = cuts[1] - 1;
                 continue;
             }
-            while (taken_cities[v].count(offspring[v][i])) {
-                offspring[v][i] = taken_cities[v].at(offspring[v][i]);
+            while (taken_cities[v][offspring[v][i]] >= 0) {
+                offspring[v][i] = taken_cities[v][offspring[v][i]];
             }
         }
+    for (int i = cuts[0]; i < cuts[1]; i++) {
+        taken_cities[0][offspring[0][i]] = -1;
+        taken_cities[1][offspring[1][i]] = -1;
+    }
     return offspring;
 }
 
@@ -270,41 +525,156 @@ std::vector<int> selection_tournament(std::vector<double> pop_fit)
     return ret;
 }
 
+/**
+ * @brief Roulette wheel built once per generation.
+ *
+ * It keeps the prefix sums of the fitnesses, so every draw is a binary search, O(log n),
+ * instead of a walk over the population. The wheel does not change after it is built,
+ * so threads can share it as long as each of them draws with its own generator.
+ */
+struct roulette_wheel_t {
+    std::vector<double> prefix;
+
+    roulette_wheel_t(const std::vector<double>& pop_fit) : prefix(pop_fit.size())
+    {
+        std::partial_sum(pop_fit.begin(), pop_fit.end(), prefix.begin());
+    }
+    double sum() const { return prefix.empty() ? 0.0 : prefix.back(); }
+    /// index of the individual that covers the point n from [0, sum())
+    int pick(double n) const
+    {
+        int picked = std::lower_bound(prefix.begin(), prefix.end(), n) - prefix.begin();
+        return std::min(picked, (int)prefix.size() - 1);
+    }
+    template <class RNG>
+    int operator()(RNG& rng) const
+    {
+        return pick(std::uniform_real_distribution<double>(0.0, sum())(rng));
+    }
+};
+
 std::vector<int> selection_roulette(std::vector<double> pop_fit)
 {
-    double sum_fit = std::accumulate(pop_fit.begin(), pop_fit.end(), 0.0);
-    std::vector<int> selected;
-    for (int i = 0; i < pop_fit.size(); i++) {
-        double n = std::uniform_real_distribution<double>(0.0, sum_fit)(rd_generator);
-        int picked = 0;
-        for (double s = 0.0; (s < n) && (picked < pop_fit.size() - 1);) {
-            s += pop_fit.at(picked);
-            if (s >= n) break;
+    roulette_wheel_t wheel(pop_fit);
+    std::vector<int> selected(pop_fit.size());
+    for (auto& e : selected)
+        e = wheel(rd_generator);
+    return selected;
+}
+
+/**
+ * @brief Stochastic universal sampling.
+ *
+ * The wheel is spun once and the individuals are picked by equally spaced pointers, so
+ * the number of copies of every individual is as close to its expected value as possible.
+ * It is a single pass over the prefix sums. The picks come out sorted, so they are shuffled
+ * before they are paired for the crossover.
+ */
+std::vector<int> selection_sus(std::vector<double> pop_fit)
+{
+    roulette_wheel_t wheel(pop_fit);
+    int n = pop_fit.size();
+    double step = wheel.sum() / n;
+    double start = std::uniform_real_distribution<double>(0.0, step)(rd_generator);
+    std::vector<int> selected(n);
+    int picked = 0;
+    for (int i = 0; i < n; i++) {
+        double pointer = start + i * step;
+        while ((picked < n - 1) && (wheel.prefix[picked] < pointer))
             picked++;
-        }
-        selected.push_back(picked);
+        selected[i] = picked;
     }
+    std::shuffle(selected.begin(), selected.end(), rd_generator);
     return selected;
 }
 
+/**
+ * @brief Indices of the k best individuals, the best first.
+ *
+ * nth_element finds them in O(n), only the k elites are sorted.
+ */
+std::vector<int> top_k(const std::vector<double>& pop_fit, int k)
+{
+    std::vector<int> idx(pop_fit.size());
+    std::iota(idx.begin(), idx.end(), 0);
+    k = std::min(k, (int)idx.size());
+    auto better = [&pop_fit](int a, int b) { return pop_fit[a] > pop_fit[b]; };
+    std::nth_element(idx.begin(), idx.begin() + k, idx.end(), better);
+    idx.resize(k);
+    std::sort(idx.begin(), idx.end(), better);
+    return idx;
+}
+
+/**
+ * @brief Indices of all the individuals from the best, the fitness is computed once for each of them.
+ */
+std::vector<int> order_by_fitness(const std::vector<double>& pop_fit)
+{
+    std::vector<int> order(pop_fit.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&pop_fit](int a, int b) { return pop_fit[a] > pop_fit[b]; });
+    return order;
+}
+
 std::function<std::vector<int>(std::vector<double>)> selection_elite_factory(std::function<std::vector<int>(std::vector<double>)> orig_selection, int n)
 {
     return [=](std::vector<double> pop) -> std::vector<int> {
-        std::vector<std::pair<int, double>> idx_fitness;
-        int i = 0;
-        std::transform(pop.begin(), pop.end(), std::back_inserter(idx_fitness), [&i](auto e) {
-            std::pair<int, double> p = {i++, e};
-            return p;
-        });
-        std::sort(idx_fitness.begin(), idx_fitness.end(), [](auto a, auto b) { return a.second > b.second; });
+        auto elite = top_k(pop, n);
         auto ret = orig_selection(pop);
-        for (int i = 0; i < n; i++) {
-            ret.at(i) = idx_fitness.at(i).first;
+        for (int i = 0; i < elite.size(); i++) {
+            ret.at(i) = elite[i];
         }
         return ret;
     };
 }
 
+/**
+ * @brief The population sorted from the best, the fitness is computed once for each individual.
+ */
+template <typename SOLUTION>
+std::vector<SOLUTION> sorted_by_fitness(const std::vector<SOLUTION>& population)
+{
+    std::vector<double> pop_fit(population.size());
+    std::transform(population.begin(), population.end(), pop_fit.begin(), fitness);
+    std::vector<SOLUTION> sorted;
+    sorted.reserve(population.size());
+    for (int i : order_by_fitness(pop_fit))
+        sorted.push_back(population[i]);
+    return sorted;
+}
+
+/**
+ * @brief The best individuals found so far, kept across the generations.
+ *
+ * Every generation offers only its own top k, found in O(n), so keeping the archive costs
+ * O(n + k log k) per generation. The same tour is never kept twice.
+ */
+struct elite_archive_t {
+    int k = 0;
+    std::vector<solution_t> members;
+    std::vector<double> members_fit;
+
+    void update(const population_t& population, const std::vector<double>& pop_fit)
+    {
+        std::vector<std::pair<double, solution_t>> candidates;
+        for (int i = 0; i < members.size(); i++)
+            candidates.push_back({members_fit[i], members[i]});
+        for (int i : top_k(pop_fit, k)) {
+            auto solution = population.get(i);
+            if (std::none_of(candidates.begin(), candidates.end(), [&](auto& c) { return c.second == solution; }))
+                candidates.push_back({pop_fit[i], solution});
+        }
+        std::stable_sort(candidates.begin(), candidates.end(), [](auto& a, auto& b) { return a.first > b.first; });
+        candidates.resize(std::min<std::size_t>(k, candidates.size()));
+        members.clear();
+        members_fit.clear();
+        for (auto& [fit, solution] : candidates) {
+            members_fit.push_back(fit);
+            members.push_back(solution);
+        }
+    }
+};
+
 
 auto print_population = [](auto results, int limit = 10) {
     for (auto e : results) {
@@ -324,51 +694,75 @@ template <typename PROBLEM = problem_t, typename SOLUTION = solution_t>
 std::vector<SOLUTION> genetic_algorithm(PROBLEM problem,
     config_t config)
 {
-    std::vector<statistics_t> conv_curve;
+    std::vector<std::pair<statistics_t, double>> conv_curve;
+    rd_generator.seed(config.seed);
     std::vector<SOLUTION> initial_population(config.pop_size);
     std::generate(initial_population.begin(), initial_population.end(), [&]() { return random_solution_for_problem(problem); });
 
-    std::vector<SOLUTION> population = initial_population;
-    std::sort(population.begin(), population.end(), [](auto a, auto b) { return fitness(a) > fitness(b); });
-    for (int iteration = 0; iteration < config.iterations; iteration++) {
-        std::vector<double> fitnesses(config.pop_size);
-#pragma omp parallel for schedule(static, 100)
-        for (int i = 0; i < config.pop_size; i++)
-            fitnesses[i] = fitness(population[i]);
+    std::vector<SOLUTION> population = sorted_by_fitness(initial_population);
+    population_t current(population.at(0).problem_p, config.pop_size);
+    for (int i = 0; i < config.pop_size; i++)
+        current.set(i, population[i]);
+    population_t next = current;
+    std::vector<double> fitnesses(config.pop_size);
+    elite_archive_t archive;
+    archive.k = std::min(config.elite_archive, config.pop_size);
+    generation_t generation;
+    edge_entropy_t entropy;
+    // the last pass only evaluates the final population
+    for (int iteration = 0;; iteration++) {
+        evaluate_all(current, fitnesses, &generation.fitness);
+        generation.update_best();
+        if (config.stop_diversity >= 0) {
+            entropy.reset();
+            for (int i = 0; i < config.pop_size; i++)
+                entropy.add(current[i], current.cities);
+            generation.diversity = entropy.entropy();
+        }
+        if (config.print_convergence_curve && (iteration > 0)) {
+            statistics_t stats;
+            stats.set(generation.fitness);
+            conv_curve.push_back({stats, generation.diversity});
+        }
+        if ((iteration == config.iterations) || (config.stop && config.stop(generation)))
+            break;
+        if (archive.k > 0) archive.update(current, fitnesses);
         auto selected = config.selection(fitnesses);
-        std::vector<SOLUTION> new_population(config.pop_size);
 
 #pragma omp parallel for
         for (int i = 0; i < (config.pop_size - 1); i += 2) {
+            // every pair has its own stream, so the result does not depend on the threads
+            philox_t rng(config.seed, iteration, i);
             std::uniform_real_distribution<double> distr(0.0, 1.0);
-            std::vector<SOLUTION> c = {population.at(selected.at(i)),
-                population.at(selected.at(i + 1))};
-            if (distr(rd_generator) > config.p_crossover) {
-                c = crossover(c);
+            std::vector<SOLUTION> c = {current.get(selected.at(i)),
+                current.get(selected.at(i + 1))};
+            if (distr(rng) > config.p_crossover) {
+                c = crossover(c, rng);
             }
             for (auto& e : c) {
-                if (distr(rd_generator) > config.p_mutation)
-                    e = mutation(e);
+                if (distr(rng) > config.p_mutation)
+                    e = mutation(e, rng);
             }
-            new_population[i + 0] = c.at(0);
-            new_population[i + 1] = c.at(1);
-        }
-        population = new_population;
-        if (config.print_convergence_curve) {
-            statistics_t stats;
-            std::vector<double> results_fit(population.size());
-            std::transform(population.begin(), population.end(), results_fit.begin(), fitness);
-            stats.calc_stats(results_fit);
-            conv_curve.push_back(stats);
+            next.set(i + 0, c.at(0));
+            next.set(i + 1, c.at(1));
         }
+        // the archived elites replace the last individuals, so the best tour is never lost
+        for (int j = 0; j < archive.members.size(); j++)
+            next.set(config.pop_size - 1 - j, archive.members[j]);
+        std::swap(current, next);
+        generation.next();
     }
+    auto order = order_by_fitness(fitnesses);
+    for (int i = 0; i < config.pop_size; i++)
+        population[i] = current.get(order[i]);
     if (config.print_convergence_curve) {
         int i =0;
-        for (auto cc : conv_curve) {
-            std::cout << (++i) << " " << cc << std::endl; 
+        for (auto [cc, diversity] : conv_curve) {
+            std::cout << (++i) << " " << cc;
+            if (config.stop_diversity >= 0) std::cout << " " << diversity;
+            std::cout << std::endl;
         }
     }
-    std::sort(population.begin(), population.end(), [](auto a, auto b) { return fitness(a) > fitness(b); });
     return population;
 }
 
@@ -380,10 +774,13 @@ config_t args_to_config(int argc, char** argv)
     std::map<std::string, std::function<std::vector<int>(std::vector<double>)>> selections;
     selections["tournament"] = selection_tournament;
     selections["roulette"] = selection_roulette;
+    selections["sus"] = selection_sus;
     selections["elite_2_tournament"] = selection_elite_factory(selection_tournament, 2);
     selections["elite_2_roulette"] = selection_elite_factory(selection_roulette, 2);
+    selections["elite_2_sus"] = selection_elite_factory(selection_sus, 2);
     selections["elite_3_tournament"] = selection_elite_factory(selection_tournament, 3);
     selections["elite_3_roulette"] = selection_elite_factory(selection_roulette, 3);
+    selections["elite_3_sus"] = selection_elite_factory(selection_sus, 3);
 
     auto help = arg(argc, argv, "help", false);
     std::string selections_list = "Available seletcions";
@@ -400,7 +797,20 @@ config_t args_to_config(int argc, char** argv)
 
     config.print_population_fit = arg(argc, argv, "print_population_fit", false, "Print every fitness from the population");
     config.result_filename = arg(argc, argv, "result_filename", std::string("route.gpx"), "Filename to save GPX data. No file if empty.");
-
+    config.elite_archive = arg(argc, argv, "elite_archive", 0, "Number of the best individuals kept across the generations and put back into every population, 0 disables it");
+    config.seed = arg(argc, argv, "seed", (unsigned long)rd(), "Random seed, the same seed gives the same result for any number of threads");
+    auto stop_stddev = arg(argc, argv, "stop_stddev", -1.0, "Stop when the standard deviation of the fitness falls to this value, negative disables it");
+    auto stop_stagnation = arg(argc, argv, "stop_stagnation", 0, "Stop when the best fitness has not improved for this many generations, 0 disables it");
+    auto stop_target = arg(argc, argv, "stop_target", 0.0, "Stop when some individual reaches this fitness, 0 disables it");
+    config.stop_diversity = arg(argc, argv, "stop_diversity", -1.0, "Stop when the edge entropy of the population falls to this value, negative disables it; it is also printed in the convergence curve");
+
+
+    std::vector<termination_f> conditions;
+    if (stop_stddev >= 0) conditions.push_back(stop_on_stddev(stop_stddev));
+    if (stop_stagnation > 0) conditions.push_back(stop_without_improvement(stop_stagnation));
+    if (stop_target > 0) conditions.push_back(stop_on_target(stop_target));
+    if (config.stop_diversity >= 0) conditions.push_back(stop_on_diversity(config.stop_diversity));
+    if (!conditions.empty()) config.stop = stop_on_any(conditions);
 
     config.selection = selections.at(config.selection_name);
     if (help) {
@@ -0,0 +1,81 @@
+/**
+ * @file philox.hpp
+ * @brief Counter-based random number generator Philox4x32-10.
+ *
+ * J. K. Salmon, M. A. Moraes, R. O. Dror, D. E. Shaw, "Parallel random numbers:
+ * as easy as 1, 2, 3", SC 2011.
+ *
+ * The output is a pure function of the key (the seed) and the counter, so every
+ * individual of every generation can get its own independent stream:
+ *
+ * @code {.c++ }
+ * philox_t rng(seed, iteration, i);
+ * std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+ * @endcode
+ *
+ * Nothing is shared between the threads, and the results are the same for any
+ * number of threads.
+ */
+#ifndef __PHILOX_HPP____
+#define __PHILOX_HPP____
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Philox4x32-10 as a UniformRandomBitGenerator (works with std:: distributions).
+ *
+ * The 128 bit counter is {draw, draw >> 32, stream_lo, stream_hi}: the stream
+ * selects the sequence, draw counts the blocks of 4 numbers inside it.
+ */
+class philox_t
+{
+public:
+    using result_type = std::uint32_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    explicit philox_t(std::uint64_t seed, std::uint32_t stream_hi = 0, std::uint32_t stream_lo = 0)
+        : key{(std::uint32_t)seed, (std::uint32_t)(seed >> 32)}, counter{0, 0, stream_lo, stream_hi}
+    {
+    }
+
+    result_type operator()()
+    {
+        if (position == 4) {
+            block = generate(counter, key);
+            if (++counter[0] == 0) ++counter[1];
+            position = 0;
+        }
+        return block[position++];
+    }
+
+    void discard(unsigned long long z)
+    {
+        for (; z > 0; z--)
+            (*this)();
+    }
+
+    /// the raw bijection, 10 rounds of Philox on one counter block
+    static std::array<std::uint32_t, 4> generate(std::array<std::uint32_t, 4> c, std::array<std::uint32_t, 2> k)
+    {
+        for (int round = 0; round < 10; round++) {
+            std::uint64_t p0 = (std::uint64_t)0xD2511F53 * c[0];
+            std::uint64_t p1 = (std::uint64_t)0xCD9E8D57 * c[2];
+            c = {(std::uint32_t)(p1 >> 32) ^ c[1] ^ k[0], (std::uint32_t)p1,
+                (std::uint32_t)(p0 >> 32) ^ c[3] ^ k[1], (std::uint32_t)p0};
+            k[0] += 0x9E3779B9;
+            k[1] += 0xBB67AE85;
+        }
+        return c;
+    }
+
+private:
+    std::array<std::uint32_t, 2> key;
+    std::array<std::uint32_t, 4> counter;
+    std::array<std::uint32_t, 4> block = {};
+    int position = 4;
+};
+
+#endif
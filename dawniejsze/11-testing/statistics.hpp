@@ -0,0 +1,165 @@
+/**
+ * @file statistics.hpp
+ * @brief Statistics of the population gathered while the fitness is computed, and the
+ * termination conditions built on them.
+ *
+ * Every value is added once, in the same loop that computes it, so nothing has to be
+ * stored or walked again:
+ *
+ * @code {.c++ }
+ * for (auto f : fitnesses) generation.fitness.add(f);
+ * generation.update_best();
+ * if (stop(generation)) break;
+ * @endcode
+ */
+#ifndef __STATISTICS_HPP____
+#define __STATISTICS_HPP____
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Mean and variance by the Welford method, together with the minimum and the maximum.
+ */
+struct running_stats_t {
+    long count = 0;
+    double mean = 0;
+    /// sum of the squared differences from the current mean
+    double m2 = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double x)
+    {
+        count++;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        min = std::min(min, x);
+        max = std::max(max, x);
+    }
+    /// the sample variance, 0 for less than two values
+    double variance() const { return (count < 2) ? 0 : m2 / (count - 1); }
+    double stddev() const { return std::sqrt(variance()); }
+};
+
+/**
+ * @brief Entropy of the edges of the population, a measure of its diversity.
+ *
+ * With F(e) the number of tours that contain the undirected edge e and N the number of
+ * tours, the entropy is -sum F(e)/N log(F(e)/N). It is 0 when all the tours are the same
+ * and grows as they share fewer edges. The counts are kept in an n x n table, and only the
+ * touched cells are cleared by reset.
+ */
+struct edge_entropy_t {
+    int cities = 0;
+    int tours = 0;
+    std::vector<int> counts;
+    std::vector<std::size_t> touched;
+
+    void add(const int* tour, int n)
+    {
+        if (cities != n) {
+            cities = n;
+            counts.assign(std::size_t(n) * n, 0);
+            touched.clear();
+        }
+        for (int i = 0; i < n; i++) {
+            int a = tour[i], b = tour[(i + 1) % n];
+            std::size_t cell = std::size_t(std::min(a, b)) * n + std::max(a, b);
+            if (counts[cell]++ == 0) touched.push_back(cell);
+        }
+        tours++;
+    }
+    double entropy() const
+    {
+        double h = 0;
+        for (auto cell : touched) {
+            double p = counts[cell] / (double)tours;
+            h -= p * std::log(p);
+        }
+        return h;
+    }
+    void reset()
+    {
+        for (auto cell : touched)
+            counts[cell] = 0;
+        touched.clear();
+        tours = 0;
+    }
+};
+
+/**
+ * @brief What the termination conditions know about the current generation.
+ */
+struct generation_t {
+    int iteration = 0;
+    running_stats_t fitness;
+    /// the best fitness seen so far, in any generation
+    double best_ever = -std::numeric_limits<double>::infinity();
+    /// generations since best_ever improved
+    int stagnation = 0;
+    /// edge entropy, NaN when it is not computed
+    double diversity = std::numeric_limits<double>::quiet_NaN();
+
+    /// called once the fitness of the generation is complete
+    void update_best()
+    {
+        if (fitness.max > best_ever) {
+            best_ever = fitness.max;
+            stagnation = 0;
+        } else {
+            stagnation++;
+        }
+    }
+    /// clears the statistics for the next generation, the best fitness and the stagnation stay
+    void next()
+    {
+        fitness = running_stats_t();
+        diversity = std::numeric_limits<double>::quiet_NaN();
+        iteration++;
+    }
+};
+
+/// true when the algorithm should stop
+using termination_f = std::function<bool(const generation_t&)>;
+
+/// the fitness of the population does not spread more than epsilon
+inline termination_f stop_on_stddev(double epsilon)
+{
+    return [=](const generation_t& g) { return (g.fitness.count > 1) && (g.fitness.stddev() <= epsilon); };
+}
+
+/// the best fitness has not improved for k generations
+inline termination_f stop_without_improvement(int k)
+{
+    return [=](const generation_t& g) { return g.stagnation >= k; };
+}
+
+/// some individual has reached the target fitness
+inline termination_f stop_on_target(double target)
+{
+    return [=](const generation_t& g) { return g.fitness.max >= target; };
+}
+
+/// the edge entropy fell to the threshold
+inline termination_f stop_on_diversity(double threshold)
+{
+    return [=](const generation_t& g) { return g.diversity <= threshold; };
+}
+
+/// stops when any of the conditions is met
+inline termination_f stop_on_any(std::vector<termination_f> conditions)
+{
+    return [=](const generation_t& g) {
+        for (auto& c : conditions)
+            if (c(g)) return true;
+        return false;
+    };
+}
+
+#endif
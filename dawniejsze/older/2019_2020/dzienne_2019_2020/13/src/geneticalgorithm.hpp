@@ -1,10 +1,20 @@
 #ifndef __SALESMAN_IMPL_GENETIC_ALGORITHM_HPP___
 #define __SALESMAN_IMPL_GENETIC_ALGORITHM_HPP___
 
+#include "island_transport.hpp"
+
 #include <algorithm>
+#include <iostream>
 #include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
 /**
  * This is the most generic genetic algoritm implementation.
 
@@ -22,7 +32,7 @@
  *
  * @return the best specimen
 */
-auto genetic_algorithm = [](auto initial_population, auto &fitness_f,
+inline auto genetic_algorithm = [](auto initial_population, auto &fitness_f,
                             auto &selection_f, auto &crossover_f, auto &mutation_f,
                             auto &term_condition_f) {
   using namespace std;
@@ -66,7 +76,7 @@ auto genetic_algorithm = [](auto initial_population, auto &fitness_f,
 
 
 
-auto island_model_ga = [](auto initial_population, auto &fitness_f,
+inline auto island_model_ga = [](auto initial_population, auto &fitness_f,
                             auto &selection_f, auto &crossover_f, auto &mutation_f,
                             int iterations, int islands_count) {
   using namespace std;
@@ -151,6 +161,166 @@ auto island_model_ga = [](auto initial_population, auto &fitness_f,
 };
 
 
+/**
+ * Island model where every island is a separate process.
+ *
+ * The islands are forked from the current process, so each of them has its
+ * own memory, allocator and OpenMP runtime. Every migration_gap iterations
+ * each island sends its best specimen to all the others through the
+ * transport (see island_transport.hpp), and in every iteration it puts the
+ * migrants that arrived in place of its worst specimens. Nobody waits for
+ * the migrants. At the end every island sends its best specimen back to the
+ * parent through a pipe.
+ *
+ * The specimen must keep its genes in the std::vector<int> solution field,
+ * like alternative_solution_t. Do not call it from inside an OpenMP parallel
+ * region, fork is not safe there.
+ *
+ * @arg generator the random engine the operators use, every island seeds its
+ * copy differently
+ * @arg transport_name "shm" or "tcp"
+ *
+ * @return the best specimen of all the islands
+*/
+inline auto island_model_multiprocess_ga =
+    [](auto initial_population, auto &fitness_f, auto &selection_f,
+       auto &crossover_f, auto &mutation_f, int iterations, int islands_count,
+       int migration_gap, std::string transport_name, auto &generator) {
+  using namespace std;
+
+  if ((islands_count <= 0) || (islands_count > (int)initial_population.size()))
+    throw invalid_argument("the number of islands must be between 1 and the population size");
+  if (migration_gap <= 0)
+    throw invalid_argument("the migration gap must be positive");
+  auto transport = make_island_transport(
+      transport_name, islands_count, initial_population.at(0).solution.size());
+  int N = initial_population.size() / islands_count;
+  unsigned seed = random_device()();
+  vector<int> results(islands_count); ///< read ends of the pipes
+  vector<pid_t> pids;
+  // when some island cannot be started, the ones already running are stopped
+  auto stop_islands = [&](int started, string reason) {
+    for (auto pid : pids)
+      kill(pid, SIGKILL);
+    for (auto pid : pids)
+      waitpid(pid, nullptr, 0);
+    for (int i = 0; i < started; i++)
+      close(results[i]);
+    throw runtime_error(reason);
+  };
+  cout.flush();
+  cerr.flush();
+  for (int island = 0; island < islands_count; island++) {
+    int fds[2];
+    if (pipe(fds) != 0)
+      stop_islands(island, "could not create the pipe for island " + to_string(island));
+    pid_t pid = fork();
+    if (pid < 0) {
+      close(fds[0]);
+      close(fds[1]);
+      stop_islands(island, "could not fork island " + to_string(island));
+    }
+    if (pid == 0) {
+      // nothing may unwind from here into the code of the parent
+      try {
+        close(fds[0]);
+        for (int i = 0; i < island; i++)
+          close(results[i]);
+        transport->attach(island);
+        generator.seed(seed + island);
+
+        decltype(initial_population) population(
+            initial_population.begin() + island * N,
+            initial_population.begin() + (island + 1) * N);
+        vector<double> fit(N); ///< list of fitnesses
+        for (int i = 0; i < N; i++)
+          fit[i] = fitness_f(population[i]);
+        vector<int> genes;
+        for (int iteration = 0; iteration < iterations; iteration++) {
+          decltype(initial_population) parents(N);  ///< parents selected
+          decltype(initial_population) children(N); ///< offspring
+          for (int i = 0; i < N; i++)
+            parents[i] = population[selection_f(fit, iteration)];
+          for (int i = 0; i < N - 1; i += 2) {
+            auto [a, b] = crossover_f(parents[i], parents[i + 1]);
+            children[i] = a;
+            children[i + 1] = b;
+          }
+          if (N % 2)
+            children[N - 1] = parents[N - 1];
+          for (int i = 0; i < N; i++)
+            children[i] = mutation_f(children[i]);
+          population = children;
+          for (int i = 0; i < N; i++)
+            fit[i] = fitness_f(population[i]);
+
+          if ((iteration % migration_gap) == (migration_gap - 1)) {
+            int best = max_element(fit.begin(), fit.end()) - fit.begin();
+            for (int i = 0; i < islands_count; i++)
+              if (i != island)
+                transport->send(i, population[best].solution);
+          }
+          while (transport->receive(genes)) {
+            int worst = min_element(fit.begin(), fit.end()) - fit.begin();
+            population[worst].solution = genes;
+            fit[worst] = fitness_f(population[worst]);
+          }
+        }
+        int best = max_element(fit.begin(), fit.end()) - fit.begin();
+        vector<uint8_t> message;
+        encode_genes(population[best].solution, message);
+        for (size_t written = 0; written < message.size();) {
+          auto n = write(fds[1], message.data() + written, message.size() - written);
+          if (n <= 0)
+            _exit(1);
+          written += n;
+        }
+        close(fds[1]);
+      } catch (...) {
+        _exit(1);
+      }
+      _exit(0);
+    }
+    close(fds[1]);
+    results[island] = fds[0];
+    pids.push_back(pid);
+  }
+
+  auto best_specimen = initial_population.at(0);
+  double best_fit = 0;
+  int returned = 0;
+  for (int island = 0; island < islands_count; island++) {
+    vector<uint8_t> message;
+    uint8_t chunk[4096];
+    for (ssize_t n; (n = read(results[island], chunk, sizeof(chunk))) > 0;)
+      message.insert(message.end(), chunk, chunk + n);
+    close(results[island]);
+    size_t pos = 0;
+    vector<int> genes;
+    if (!decode_genes(message.data(), message.size(), pos, genes)) {
+      cerr << "[E] island " << island << " did not return its result" << endl;
+      continue;
+    }
+    auto specimen = initial_population.at(0);
+    specimen.solution = genes;
+    double f = fitness_f(specimen);
+    if ((returned++ == 0) || (f > best_fit)) {
+      best_fit = f;
+      best_specimen = specimen;
+    }
+  }
+  for (int island = 0; island < islands_count; island++) {
+    int status;
+    if ((waitpid(pids[island], &status, 0) != pids[island]) ||
+        !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+      cerr << "[E] island " << island << " failed" << endl;
+  }
+  if (returned == 0)
+    throw runtime_error("none of the islands returned its result");
+  return best_specimen;
+};
+
+
 
 
 #endif
@@ -6,7 +6,7 @@
 #include <vector>
 #include <iostream>
 
-auto process_arguments = [](int argc, char **argv) -> std::map<std::string, std::string>{
+inline auto process_arguments = [](int argc, char **argv) -> std::map<std::string, std::string>{
   using namespace std;
   map<string, string> arguments_map;
   for (auto a : vector<string>(argv + 1, argv + argc)) {
@@ -0,0 +1,348 @@
+#include "island_transport.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+void put_varint(uint32_t v, std::vector<uint8_t> &out) {
+  while (v >= 0x80) {
+    out.push_back(uint8_t(v) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(uint8_t(v));
+}
+
+bool get_varint(const uint8_t *in, size_t size, size_t &pos, uint32_t &v) {
+  v = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (pos >= size)
+      return false;
+    uint8_t b = in[pos++];
+    v |= uint32_t(b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return true;
+  }
+  return false;
+}
+
+/// the smallest ring for one pair of islands, in bytes
+constexpr size_t min_ring_capacity = 1 << 15;
+/// the ring always has room for this many of the longest chromosomes
+constexpr size_t ring_messages = 16;
+
+/**
+ * Single producer, single consumer ring in the shared memory. The positions
+ * only grow, the index in the data is the position modulo the capacity. The
+ * data follows the header in the same segment. Every message is its length
+ * (4 bytes) and the encoded chromosome.
+ */
+struct shm_ring_t {
+  alignas(64) std::atomic<uint64_t> head; ///< moved by the receiving island
+  alignas(64) std::atomic<uint64_t> tail; ///< moved by the sending island
+
+  uint8_t *data() { return reinterpret_cast<uint8_t *>(this + 1); }
+  void copy_in(uint64_t pos, const void *src, size_t n, size_t capacity) {
+    for (size_t i = 0; i < n; i++)
+      data()[(pos + i) % capacity] = static_cast<const uint8_t *>(src)[i];
+  }
+  void copy_out(uint64_t pos, void *dst, size_t n, size_t capacity) {
+    for (size_t i = 0; i < n; i++)
+      static_cast<uint8_t *>(dst)[i] = data()[(pos + i) % capacity];
+  }
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the rings are shared between processes");
+
+class shm_transport_t : public island_transport_t {
+  int islands;
+  int island = -1;
+  size_t capacity; ///< bytes of data in every ring
+  size_t stride;   ///< bytes from one ring to the next
+  uint8_t *segment = nullptr;
+  size_t bytes;
+  int next_source = 0; ///< where receive starts, so no sender is starved
+  std::vector<uint8_t> message;
+
+  shm_ring_t &ring(int from, int to) {
+    return *reinterpret_cast<shm_ring_t *>(segment +
+                                           (from * islands + to) * stride);
+  }
+
+public:
+  shm_transport_t(int islands_, int genes)
+      : islands(islands_),
+        // a gene takes at most 5 bytes as varint, and so does the count
+        capacity(std::max(min_ring_capacity,
+                          ring_messages * (sizeof(uint32_t) + 5 * (genes + 1)))),
+        stride(sizeof(shm_ring_t) + (capacity + 63) / 64 * 64),
+        bytes(stride * islands_ * islands_) {
+    std::string name = "/salesman_islands_" + std::to_string(getpid());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+      throw std::runtime_error("shm_open failed for " + name);
+    if (ftruncate(fd, bytes) != 0) {
+      close(fd);
+      shm_unlink(name.c_str());
+      throw std::runtime_error("could not resize " + name);
+    }
+    void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    // the children inherit the mapping, so the name is not needed any more
+    shm_unlink(name.c_str());
+    if (p == MAP_FAILED)
+      throw std::runtime_error("could not map " + name);
+    segment = static_cast<uint8_t *>(p);
+    for (int from = 0; from < islands; from++)
+      for (int to = 0; to < islands; to++) {
+        auto r = new (&ring(from, to)) shm_ring_t;
+        r->head.store(0);
+        r->tail.store(0);
+      }
+  }
+  ~shm_transport_t() { munmap(segment, bytes); }
+
+  void attach(int island_) override { island = island_; }
+
+  void send(int to, const std::vector<int> &genes) override {
+    message.clear();
+    encode_genes(genes, message);
+    auto &r = ring(island, to);
+    uint64_t tail = r.tail.load(std::memory_order_relaxed);
+    uint64_t head = r.head.load(std::memory_order_acquire);
+    uint32_t length = message.size();
+    if (sizeof(length) + length > capacity)
+      throw std::length_error("the chromosome of " +
+                              std::to_string(genes.size()) +
+                              " genes does not fit in the ring");
+    if (capacity - (tail - head) < sizeof(length) + length)
+      return; // the ring is full for now, the migrant is dropped
+    r.copy_in(tail, &length, sizeof(length), capacity);
+    r.copy_in(tail + sizeof(length), message.data(), length, capacity);
+    r.tail.store(tail + sizeof(length) + length, std::memory_order_release);
+  }
+
+  bool receive(std::vector<int> &genes) override {
+    for (int k = 0; k < islands; k++) {
+      int from = (next_source + k) % islands;
+      if (from == island)
+        continue;
+      auto &r = ring(from, island);
+      uint64_t head = r.head.load(std::memory_order_relaxed);
+      if (head == r.tail.load(std::memory_order_acquire))
+        continue;
+      uint32_t length;
+      r.copy_out(head, &length, sizeof(length), capacity);
+      message.resize(length);
+      r.copy_out(head + sizeof(length), message.data(), length, capacity);
+      r.head.store(head + sizeof(length) + length, std::memory_order_release);
+      next_source = (from + 1) % islands;
+      size_t pos = 0;
+      return decode_genes(message.data(), message.size(), pos, genes);
+    }
+    return false;
+  }
+};
+
+/**
+ * Every island listens on its own port on localhost. The listening sockets
+ * are opened before fork, so every island knows the ports of the others.
+ * The connections are opened when the first migrant is sent. The messages
+ * are just the encoded chromosomes, they tell where they end by themselves.
+ */
+class tcp_transport_t : public island_transport_t {
+  struct connection_t {
+    int fd = -1;
+    std::vector<uint8_t> buffer;
+  };
+  /// the migrants waiting in the outgoing buffer above this size are dropped
+  static constexpr size_t max_pending = 1 << 16;
+
+  int islands;
+  int island = -1;
+  std::vector<int> listeners;
+  std::vector<uint16_t> ports;
+  std::vector<connection_t> outgoing; ///< by the destination island
+  std::vector<connection_t> incoming;
+  std::deque<std::vector<int>> arrived;
+
+  static void close_connection(connection_t &c) {
+    if (c.fd >= 0)
+      close(c.fd);
+    c.fd = -1;
+    c.buffer.clear();
+  }
+
+  bool connect_to(int to) {
+    auto &c = outgoing[to];
+    c.fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (c.fd < 0)
+      return false;
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(ports[to]);
+    if (connect(c.fd, (sockaddr *)&address, sizeof(address)) != 0) {
+      close_connection(c); // the island has already finished
+      return false;
+    }
+    int one = 1;
+    setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL) | O_NONBLOCK);
+    return true;
+  }
+
+  void flush(connection_t &c) {
+    while ((c.fd >= 0) && !c.buffer.empty()) {
+      auto n = ::send(c.fd, c.buffer.data(), c.buffer.size(),
+                      MSG_DONTWAIT | MSG_NOSIGNAL);
+      if (n > 0) {
+        c.buffer.erase(c.buffer.begin(), c.buffer.begin() + n);
+      } else {
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK))
+          close_connection(c);
+        return;
+      }
+    }
+  }
+
+  void read_all(connection_t &c) {
+    uint8_t chunk[4096];
+    for (;;) {
+      auto n = recv(c.fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+      if (n > 0) {
+        c.buffer.insert(c.buffer.end(), chunk, chunk + n);
+        continue;
+      }
+      if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))) {
+        close(c.fd);
+        c.fd = -1;
+      }
+      break;
+    }
+    size_t pos = 0;
+    std::vector<int> genes;
+    while (decode_genes(c.buffer.data(), c.buffer.size(), pos, genes))
+      arrived.push_back(genes);
+    c.buffer.erase(c.buffer.begin(), c.buffer.begin() + pos);
+  }
+
+public:
+  tcp_transport_t(int islands_)
+      : islands(islands_), listeners(islands_, -1), ports(islands_) {
+    for (int i = 0; i < islands; i++) {
+      listeners[i] = socket(AF_INET, SOCK_STREAM, 0);
+      sockaddr_in address = {};
+      address.sin_family = AF_INET;
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      address.sin_port = 0; // any free port
+      socklen_t length = sizeof(address);
+      if ((listeners[i] < 0) ||
+          (bind(listeners[i], (sockaddr *)&address, sizeof(address)) != 0) ||
+          (listen(listeners[i], islands) != 0) ||
+          (getsockname(listeners[i], (sockaddr *)&address, &length) != 0))
+        throw std::runtime_error("could not listen for island " +
+                                 std::to_string(i) + ": " + strerror(errno));
+      ports[i] = ntohs(address.sin_port);
+      fcntl(listeners[i], F_SETFL, fcntl(listeners[i], F_GETFL) | O_NONBLOCK);
+    }
+  }
+  ~tcp_transport_t() {
+    for (auto fd : listeners)
+      if (fd >= 0)
+        close(fd);
+    for (auto &c : outgoing)
+      close_connection(c);
+    for (auto &c : incoming)
+      close_connection(c);
+  }
+
+  void attach(int island_) override {
+    island = island_;
+    for (int i = 0; i < islands; i++)
+      if ((i != island) && (listeners[i] >= 0)) {
+        close(listeners[i]);
+        listeners[i] = -1;
+      }
+    outgoing.resize(islands);
+  }
+
+  void send(int to, const std::vector<int> &genes) override {
+    auto &c = outgoing[to];
+    if ((c.fd < 0) && !connect_to(to))
+      return;
+    flush(c);
+    if (c.buffer.size() > max_pending)
+      return; // the other island does not keep up, the migrant is dropped
+    encode_genes(genes, c.buffer);
+    flush(c);
+  }
+
+  bool receive(std::vector<int> &genes) override {
+    if (arrived.empty()) {
+      int fd;
+      while ((fd = accept(listeners[island], nullptr, nullptr)) >= 0) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        incoming.push_back({fd, {}});
+      }
+      for (auto &c : incoming)
+        read_all(c);
+      for (auto &c : outgoing)
+        flush(c);
+      for (auto it = incoming.begin(); it != incoming.end();)
+        it = (it->fd < 0) ? incoming.erase(it) : it + 1;
+    }
+    if (arrived.empty())
+      return false;
+    genes = std::move(arrived.front());
+    arrived.pop_front();
+    return true;
+  }
+};
+
+} // namespace
+
+void encode_genes(const std::vector<int> &genes, std::vector<uint8_t> &out) {
+  put_varint(genes.size(), out);
+  for (auto g : genes)
+    put_varint(g, out);
+}
+
+bool decode_genes(const uint8_t *in, size_t size, size_t &pos,
+                  std::vector<int> &genes) {
+  size_t p = pos;
+  uint32_t count;
+  if (!get_varint(in, size, p, count) || (count > size - p))
+    return false; // every gene takes at least one byte
+  genes.resize(count);
+  for (auto &g : genes) {
+    uint32_t v;
+    if (!get_varint(in, size, p, v))
+      return false;
+    g = v;
+  }
+  pos = p;
+  return true;
+}
+
+std::shared_ptr<island_transport_t>
+make_island_transport(std::string name, int islands, int genes) {
+  if (name == "shm")
+    return std::make_shared<shm_transport_t>(islands, genes);
+  if (name == "tcp")
+    return std::make_shared<tcp_transport_t>(islands);
+  throw std::invalid_argument("unknown island transport " + name);
+}
@@ -0,0 +1,53 @@
+#ifndef __SALESMAN_ISLAND_TRANSPORT_HPP___
+#define __SALESMAN_ISLAND_TRANSPORT_HPP___
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Appends the chromosome to out in the compact binary form: the number of
+ * genes and then the genes, every one as LEB128 varint, so genes smaller than
+ * 128 take one byte.
+ */
+void encode_genes(const std::vector<int> &genes, std::vector<uint8_t> &out);
+
+/**
+ * Decodes one chromosome written by encode_genes starting at in[pos].
+ *
+ * @return false if the buffer ends before the chromosome does
+ */
+bool decode_genes(const uint8_t *in, size_t size, size_t &pos,
+                  std::vector<int> &genes);
+
+/**
+ * The channel between islands that are separate processes.
+ *
+ * The transport is created by the parent process before fork. Every child
+ * calls attach(island) once and then uses only its own end. Sending never
+ * blocks: when there is no room at the moment the migrant is dropped, so
+ * islands never wait for each other.
+ */
+class island_transport_t {
+public:
+  virtual ~island_transport_t() = default;
+  /// called in the child process that runs the given island
+  virtual void attach(int island) = 0;
+  virtual void send(int to, const std::vector<int> &genes) = 0;
+  /// takes one migrant if any has arrived
+  virtual bool receive(std::vector<int> &genes) = 0;
+};
+
+/**
+ * @arg name "shm" - a POSIX shared memory segment with one lock-free ring per
+ * pair of islands; "tcp" - TCP connections on localhost, every island
+ * listens on its own port
+ * @arg islands the number of islands
+ * @arg genes the length of the chromosomes, the rings are sized for it
+ */
+std::shared_ptr<island_transport_t>
+make_island_transport(std::string name, int islands, int genes);
+
+#endif
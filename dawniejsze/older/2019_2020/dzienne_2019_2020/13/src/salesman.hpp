@@ -5,9 +5,11 @@
 #include "json.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <list>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <vector>
 #include <random>
@@ -53,6 +55,66 @@ public:
   }
 };
 
+/**
+ * @brief precomputed great-circle distances between the cities
+ *
+ * Every city is kept as a 3-D unit vector. The chord between two unit vectors
+ * is 2*sin(c/2), where c is the central angle from the haversine formula, so
+ * the distance needs one sqrt and one asin instead of the sin, cos and atan2
+ * calls of city_t::distance. The results agree with city_t::distance up to
+ * the rounding errors (relative difference around 1e-14 for our inputs). Small
+ * problems additionally get the full distance matrix, so the goal function
+ * does only lookups.
+ */
+class geo_distance_t {
+public:
+  static constexpr double earth_radius = 6371e3; // metres
+  /**
+   * @brief problems up to this number of cities get the distance matrix
+   */
+  static constexpr unsigned max_matrix_cities = 4096;
+
+  geo_distance_t() = default;
+
+  explicit geo_distance_t(const std::vector<city_t> &cities)
+      : n(cities.size()), unit(cities.size()) {
+    for (unsigned i = 0; i < n; i++) {
+      double fi = cities[i].latitude * M_PI / 180.0;
+      double lambda = cities[i].longitude * M_PI / 180.0;
+      unit[i] = {std::cos(fi) * std::cos(lambda), std::cos(fi) * std::sin(lambda),
+                 std::sin(fi)};
+    }
+    if (n <= max_matrix_cities) {
+      matrix.resize(n * n);
+      for (unsigned i = 0; i < n; i++)
+        for (unsigned j = 0; j < n; j++)
+          matrix[i * n + j] = great_circle(i, j);
+    }
+  }
+
+  /**
+   * @brief distance between the cities with the given indices, in metres
+   */
+  double operator()(int a, int b) const {
+    if (!matrix.empty())
+      return matrix[a * n + b];
+    return great_circle(a, b);
+  }
+
+  double great_circle(int a, int b) const {
+    double dx = unit[a][0] - unit[b][0];
+    double dy = unit[a][1] - unit[b][1];
+    double dz = unit[a][2] - unit[b][2];
+    double chord = std::sqrt(dx * dx + dy * dy + dz * dz);
+    return 2.0 * earth_radius * std::asin(std::min(1.0, chord / 2.0));
+  }
+
+private:
+  std::size_t n = 0;
+  std::vector<std::array<double, 3>> unit;
+  std::vector<double> matrix;
+};
+
 /**
  * @brief the problem definition
  *
@@ -64,6 +126,15 @@ public:
    * @brief list of the cities to visit.
    */
   std::vector<city_t> cities;
+  /**
+   * @brief distances between the cities, prepared once for the list above
+   */
+  geo_distance_t distances;
+
+  problem_t(std::vector<city_t> cities_ = {})
+      : cities(std::move(cities_)), distances(cities) {}
+
+  double distance(int a, int b) const { return distances(a, b); }
 };
 
 /**
@@ -131,7 +202,7 @@ public:
     auto prev_city =
         solution.back(); // we must come back, so include the last city
     for (auto city : solution) { // now walk between cities
-      sum += problem->cities[city].distance(problem->cities[prev_city]);
+      sum += problem->distance(city, prev_city);
       prev_city = city;
     }
     return sum;
@@ -268,8 +339,26 @@ public:
     return solution_candidate;
   }
 
+  /**
+   * the same as get_solution().goal(), but decodes the order on the fly
+   * */
   double goal() const {
-    return get_solution().goal();
+    std::vector<int> indexes(solution.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    double sum = 0.0;
+    int first_city = -1, prev_city = -1;
+    for (auto idx : solution) {
+      int city = indexes[idx];
+      indexes.erase(indexes.begin() + idx);
+      if (prev_city >= 0)
+        sum += problem->distance(prev_city, city);
+      else
+        first_city = city;
+      prev_city = city;
+    }
+    if (prev_city >= 0)
+      sum += problem->distance(prev_city, first_city);
+    return sum;
   }
 
 
@@ -4,6 +4,12 @@
 #include <algorithm>
 #include <random>
 #include <functional>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
 
 using namespace std;
 
@@ -13,16 +19,44 @@ using crossover_f_t = function<pair<chromosome_t, chromosome_t>(chromosome_t &,
 using mutation_f_t = function<chromosome_t(chromosome_t, double)>;
 
 random_device rd;
-mt19937 randgen(rd());
+const unsigned int base_seed = rd();
+atomic<unsigned int> seeded_threads(0);
+/// kazdy watek (wyspa) ma wlasny generator z innym ziarnem
+thread_local mt19937 randgen(base_seed + seeded_threads++);
+
+/**
+ * statystyki populacji liczone w jednym przejsciu - srednia i wariancja metoda Welforda,
+ * do tego najlepszy i najgorszy wynik. kazdy osobnik jest oceniany tylko raz
+ * */
+struct running_stats_t
+{
+	int count = 0;
+	double mean = 0;
+	double m2 = 0; // suma kwadratow odchylen od biezacej sredniej
+	double min = numeric_limits<double>::infinity();
+	double max = -numeric_limits<double>::infinity();
+
+	void add(double x)
+	{
+		count++;
+		double delta = x - mean;
+		mean += delta / count;
+		m2 += delta * (x - mean);
+		min = std::min(min, x);
+		max = std::max(max, x);
+	}
+	double stddev() const { return count ? sqrt(m2 / count) : 0; }
+};
 
 auto ga_iteration = [](vector<chromosome_t> population,
 					   selection_f_t select,
 					   crossover_f_t crossover,
 					   mutation_f_t mutation,
 					   double p_crossover,
-					   double p_mutation) {
+					   double p_mutation,
+					   bool parallel = true) {
 	vector<chromosome_t> new_pop(population.size());
-#pragma omp parallel for
+#pragma omp parallel for if (parallel)
 	for (int c = 0; c < population.size() / 2; c++)
 	{
 		chromosome_t parent1 = select(population);
@@ -106,12 +140,176 @@ auto ep = [](
 	return population;
 };
 
+/**
+ * ograniczona kolejka bez blokad dla jednego producenta i jednego konsumenta.
+ * gdy jest pelna, push zwraca false i migrant przepada - wyspa nigdy na nic nie czeka
+ * */
+template <class T>
+class spsc_queue_t
+{
+	vector<T> buffer;
+	alignas(64) atomic<size_t> head{0}; // tu czyta konsument
+	alignas(64) atomic<size_t> tail{0}; // tu pisze producent
+
+public:
+	spsc_queue_t(size_t capacity) : buffer(capacity + 1) {}
+	bool push(const T &v)
+	{
+		auto t = tail.load(memory_order_relaxed);
+		auto next = (t + 1) % buffer.size();
+		if (next == head.load(memory_order_acquire))
+			return false;
+		buffer[t] = v;
+		tail.store(next, memory_order_release);
+		return true;
+	}
+	bool pop(T &v)
+	{
+		auto h = head.load(memory_order_relaxed);
+		if (h == tail.load(memory_order_acquire))
+			return false;
+		v = std::move(buffer[h]);
+		head.store((h + 1) % buffer.size(), memory_order_release);
+		return true;
+	}
+};
+
+/**
+ * do kogo wyspa i wysyla migrantow: ring - do obu sasiadow na kole, torus - do czterech sasiadow
+ * na siatce rows x cols zawinietej w obu kierunkach, full - do wszystkich pozostalych
+ * */
+vector<int> island_neighbours(string topology, int i, int islands)
+{
+	vector<int> ret;
+	if (topology == "ring")
+	{
+		ret = {(i + 1) % islands, (i + islands - 1) % islands};
+	}
+	else if (topology == "torus")
+	{
+		int rows = sqrt(islands);
+		while (islands % rows)
+			rows--;
+		int cols = islands / rows;
+		int r = i / cols, c = i % cols;
+		ret = {r * cols + (c + 1) % cols, r * cols + (c + cols - 1) % cols,
+			   ((r + 1) % rows) * cols + c, ((r + rows - 1) % rows) * cols + c};
+	}
+	else if (topology == "full")
+	{
+		for (int j = 0; j < islands; j++)
+			ret.push_back(j);
+	}
+	else
+	{
+		throw invalid_argument("unknown topology " + topology);
+	}
+	sort(ret.begin(), ret.end());
+	ret.erase(unique(ret.begin(), ret.end()), ret.end());
+	ret.erase(remove(ret.begin(), ret.end(), i), ret.end());
+	return ret;
+}
+
+/**
+ * model wyspowy - kazdy dem to osobny watek przez caly czas dzialania algorytmu.
+ * co migration_gap iteracji wyspa wysyla migration_rate najlepszych osobnikow do sasiadow,
+ * a w kazdej iteracji przyjmuje to, co do niej doszlo. migranci ida przez kolejki spsc_queue_t,
+ * po jednej na kazda krawedz topologii, wiec wyspy nie czekaja na siebie na zadnej barierze
+ * */
+auto ep_islands = [](
+					  vector<chromosome_t> population,
+					  int iterations,
+					  selection_f_t select,
+					  crossover_f_t crossover,
+					  mutation_f_t mutation,
+					  double p_crossover,
+					  double p_mutation,
+					  int islands,
+					  string topology,
+					  int migration_rate,
+					  int migration_gap,
+					  auto fitness,
+					  bool random_replace = false,
+					  int queue_capacity = 16) {
+	vector<unique_ptr<spsc_queue_t<chromosome_t>>> queues;
+	vector<vector<spsc_queue_t<chromosome_t> *>> outgoing(islands), incoming(islands);
+	for (int i = 0; i < islands; i++)
+		for (int j : island_neighbours(topology, i, islands))
+		{
+			queues.push_back(make_unique<spsc_queue_t<chromosome_t>>(queue_capacity * migration_rate));
+			outgoing[i].push_back(queues.back().get());
+			incoming[j].push_back(queues.back().get());
+		}
+
+	vector<vector<chromosome_t>> demes(islands);
+	for (int i = 0; i < islands; i++)
+		demes[i] = {population.begin() + (i * population.size() / islands),
+					population.begin() + ((i + 1) * population.size() / islands)};
+
+	auto island = [&](int i) {
+		auto &deme = demes[i];
+		vector<double> fit(deme.size());
+		auto evaluate = [&]() {
+			for (int j = 0; j < deme.size(); j++)
+				fit[j] = fitness(deme[j]);
+		};
+		chromosome_t migrant;
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			deme = ga_iteration(deme, select, crossover, mutation, p_crossover, p_mutation, false);
+			bool evaluated = false;
+			if ((iteration % migration_gap) == (migration_gap - 1))
+			{
+				evaluate();
+				evaluated = true;
+				vector<int> idx(deme.size());
+				iota(idx.begin(), idx.end(), 0);
+				int k = min<int>(migration_rate, idx.size());
+				nth_element(idx.begin(), idx.begin() + k, idx.end(), [&](int a, int b) { return fit[a] > fit[b]; });
+				for (int m = 0; m < k; m++)
+					for (auto q : outgoing[i])
+						q->push(deme[idx[m]]);
+			}
+			for (auto q : incoming[i])
+				while (q->pop(migrant))
+				{
+					int replaced;
+					if (random_replace)
+					{
+						replaced = uniform_int_distribution<int>(0, deme.size() - 1)(randgen);
+					}
+					else
+					{
+						if (!evaluated)
+							evaluate();
+						evaluated = true;
+						replaced = min_element(fit.begin(), fit.end()) - fit.begin();
+						fit[replaced] = fitness(migrant);
+					}
+					deme[replaced] = migrant;
+				}
+		}
+	};
+
+	vector<thread> threads;
+	for (int i = 0; i < islands; i++)
+		threads.emplace_back(island, i);
+	for (auto &t : threads)
+		t.join();
+
+	population.clear();
+	for (auto &d : demes)
+		population.insert(population.end(), d.begin(), d.end());
+	return population;
+};
+
 int main(int argc, char **argv)
 {
 
 	int demes = 5, migration_rate = 1, migration_gap = 5;
 	bool random_replace_in_demes = true;
-	if (argc == 5)
+	string topology = "";
+	if (argc >= 5)
 	{
 		demes = stoi(argv[1]);
 		migration_rate = stoi(argv[2]);
@@ -120,6 +318,13 @@ int main(int argc, char **argv)
 		cerr << "demes = " << demes << " migration_rate = " << migration_rate << "  migration_gap = " << migration_gap <<
 		" replace = " << random_replace_in_demes  << endl;
 	}
+	if (argc >= 6)
+	{
+		// ring, torus albo full - kazdy dem we wlasnym watku
+		topology = argv[5];
+		cerr << "topology = " << topology << endl;
+	}
+	bool converge = (argc >= 7) && (string(argv[6]) == "converge");
 
 	vector<pair<double, double>> cities_coordinates = {
 		{8.414709848078965, 5.403023058681398},
@@ -210,14 +415,25 @@ int main(int argc, char **argv)
 
 		// to jest generowanie jednego z potomkow, aby uzyskac pare, nalezy wywolac to dwa razy
 		// z odpowiednio zamieniona kolejnoscia rodzicow
-		auto swap_part = [cpoint1, cpoint2](chromosome_t p1, chromosome_t p2) -> chromosome_t {
-			// kasujemy z rodzica numer 2 indeksy z fragmentu ciecia
+		auto swap_part = [cpoint1, cpoint2](const chromosome_t &p1, const chromosome_t &p2) -> chromosome_t {
+			// zaznaczamy miasta z fragmentu ciecia rodzica numer 1, zeby pominac je w rodzicu numer 2
+			vector<char> taken(p1.size(), 0);
 			for (int i = cpoint1; i < cpoint2; i++)
-				p2.erase(std::remove(p2.begin(), p2.end(), p1.at(i)), p2.end());
-			// wstawiamy wycinany fragment na odpowiednie miejsce do potomka (ogonek sie odpowiednio przesunie)
-			p2.insert(p2.begin() + cpoint1, p1.begin() + cpoint1, p1.begin() + cpoint2);
+				taken[p1[i]] = 1;
+			// przepisujemy rodzica numer 2 bez tych miast, a gdy dojdziemy do cpoint1, wstawiamy wyciety fragment
+			chromosome_t child;
+			child.reserve(p2.size());
+			for (auto city : p2)
+			{
+				if (child.size() == (size_t)cpoint1)
+					child.insert(child.end(), p1.begin() + cpoint1, p1.begin() + cpoint2);
+				if (!taken[city])
+					child.push_back(city);
+			}
+			if (child.size() == (size_t)cpoint1)
+				child.insert(child.end(), p1.begin() + cpoint1, p1.begin() + cpoint2);
 			// zwracamy potomka
-			return p2;
+			return child;
 		};
 
 		return {swap_part(p1, p2), swap_part(p2, p1)};
@@ -225,7 +441,7 @@ int main(int argc, char **argv)
 
 	// mutacja poprzez zamiane
 	auto mutation_swap = [](chromosome_t c, double pm) -> chromosome_t {
-		static uniform_real_distribution<double> dist(0.0, 1.0);
+		uniform_real_distribution<double> dist(0.0, 1.0);
 		if (dist(randgen) < pm)
 		{
 			uniform_int_distribution<int> cpointrnd(0, c.size() - 1);
@@ -266,55 +482,60 @@ int main(int argc, char **argv)
 
 	/// uruchomienie programu ewolucyjnego
 	//auto initial_population = init_pop(cities_coordinates.size() * cities_coordinates.size(), cities_coordinates.size());
-	auto initial_population = init_pop(50, cities_coordinates.size());
+	auto initial_population = init_pop(max(50, demes * 10), cities_coordinates.size());
 	print_stats("initial", initial_population, false);
 
-	int last_improvement = 0;
-	auto best_so_far = *std::max_element(initial_population.begin(), initial_population.end(), [&](auto &a, auto &b) {
-		return fitness(a) < fitness(b);
-	});
-
-	auto term_no_improvement = [&last_improvement, &best_so_far, &fitness](std::vector<chromosome_t> pop, int iteration) {
-		auto current_best = *std::max_element(pop.begin(), pop.end(), [&](auto &a, auto &b) {
-			return fitness(a) < fitness(b);
-		});
-		//cout << "# " << iteration << " " << fitness(best_so_far) << " < " << fitness(current_best) << " " << iteration << "-" << last_improvement << endl;
-		if (fitness(best_so_far) < fitness(current_best))
-		{
-			last_improvement = iteration;
-			best_so_far = current_best;
-		}
-		if ((iteration - last_improvement) < 100)
-		{
-			return true;
-		}
-		else
-		{
-			cout << "#finish at " << iteration << endl;
-			return false;
-		}
+	/// warunek zakonczenia z warunkow czastkowych (stats, iteration) -> czy liczyc dalej;
+	/// populacja jest oceniana raz na iteracje, niezaleznie od liczby warunkow
+	auto term_all = [&fitness](auto... conditions) {
+		return [=](const vector<chromosome_t> &pop, int iteration) mutable {
+			running_stats_t stats;
+			for (auto &c : pop)
+				stats.add(fitness(c));
+			return (conditions(stats, iteration) && ...);
+		};
 	};
-
-	auto term_stddev = [&fitness](std::vector<chromosome_t> pop, int iteration) {
-		double stddev = 0;
-		double avg = accumulate(pop.begin(), pop.end(), (double)0.0,
-								[&](double a, chromosome_t b) { return a + fitness(b); }) /
-					 (double)pop.size();
-		double sum = accumulate(pop.begin(), pop.end(), (double)0.0,
-								[&](double a, chromosome_t b) { return a + pow((fitness(b) - avg), 2); });
-		stddev = sqrt(sum / (double)pop.size());
-		cout << iteration << " " << avg << " " << sum << " " << stddev;
-		//cout << " #";
-		//for (int i = 0; i < pop.size(); i++) cout << " " << fitness(pop[i]);
-		cout << endl;
-		return stddev > 0.0000001; //iteration < 1000;
+	// rozrzut fitness jest wiekszy niz epsilon
+	auto stddev_above = [](double epsilon) {
+		return [=](const running_stats_t &stats, int) { return stats.stddev() > epsilon; };
 	};
+	// najlepszy wynik poprawil sie w ciagu ostatnich k iteracji
+	auto improved_within = [](int k) {
+		return [=, best = -numeric_limits<double>::infinity(), last_improvement = 0](const running_stats_t &stats, int iteration) mutable {
+			if (stats.max > best)
+			{
+				best = stats.max;
+				last_improvement = iteration;
+			}
+			return (iteration - last_improvement) < k;
+		};
+	};
+	// zaden osobnik nie osiagnal jeszcze docelowego fitness
+	auto target_not_reached = [](double target) {
+		return [=](const running_stats_t &stats, int) { return stats.max < target; };
+	};
+	// wypisuje krzywa zbieznosci, nigdy nie konczy
+	auto print_curve = [](const running_stats_t &stats, int iteration) {
+		cout << iteration << " " << stats.mean << " " << stats.m2 << " " << stats.stddev() << endl;
+		return true;
+	};
+
+	auto term_no_improvement = term_all(improved_within(100));
+	auto term_stddev = term_all(print_curve, stddev_above(0.0000001));
 
-	auto term_iterations = [](auto pop, int i) { return i < 1000; };
+	auto term_iterations = [](const auto &pop, int i) { return i < 1000; };
+	// siodmy argument converge - zakonczenie, gdy populacja sie zbiegnie, ale nie pozniej niz po 1000 iteracjach
+	auto term_converged = term_all([](const running_stats_t &, int i) { return i < 1000; },
+								   stddev_above(0.0000001), improved_within(100), target_not_reached(1.0 / (1 + 2 * M_PI * 10.0)));
 
-	auto result_population = ep(
-		initial_population, term_iterations, select, corssover_ox, mutation_swap, 0.8, 0.1, 
-		demes, migration_rate, migration_gap, fitness, random_replace_in_demes);
+	auto result_population = (topology == "")
+		? ((converge)
+			   ? ep(initial_population, term_converged, select, corssover_ox, mutation_swap, 0.8, 0.1,
+					demes, migration_rate, migration_gap, fitness, random_replace_in_demes)
+			   : ep(initial_population, term_iterations, select, corssover_ox, mutation_swap, 0.8, 0.1,
+					demes, migration_rate, migration_gap, fitness, random_replace_in_demes))
+		: ep_islands(initial_population, 1000, select, corssover_ox, mutation_swap, 0.8, 0.1,
+					 demes, topology, migration_rate, migration_gap, fitness, random_replace_in_demes);
 	print_stats("result", result_population, false);
 	/// ile powinno wyjsc - okolo, poniewaz miasta nie pokrywaja wszystkich punktow kola, wiec wynik faktyczny powinien byc troche mniejszy
 	std::cout
@@ -13,10 +13,13 @@
 #include <future>
 //#include <openmp>
 
+#include "philox.hpp"
 
-std::random_device rd;
-std::mt19937 randgen(rd());
-
+/**
+ * select, crossover and mutation get the random generator as the last argument. Every pair of
+ * children has its own stream philox_t(seed, iteration, c), so the result depends only on the
+ * seed and not on the number of threads.
+ */
 
 auto genetic_algorithm = [](
                              auto fitness,
@@ -27,6 +30,7 @@ auto genetic_algorithm = [](
                              double p_crossover,
                              auto mutation,
                              double p_mutation,
+                             std::uint64_t seed,
                              std::function<void(int c, double dt)> on_statistics = [](int c, double dt) {},
                              std::function<void(int i, double current_goal_val, double goal_val)> on_iteration = [](int i, double current_goal_val, double goal_val) {}) {
     using namespace std;
@@ -42,16 +46,17 @@ auto genetic_algorithm = [](
         auto iterations_ = population.size();
         #pragma omp parallel for
         for (int c = 0; c < iterations_; c += 2) {
+            philox_t rng(seed, iteration, c);
             uniform_real_distribution<double> should_mutate;
             uniform_real_distribution<double> should_crossover;
-            auto parent1 = population.at(select(population_fit));
-            auto parent2 = population.at(select(population_fit));
-            auto [child1, child2] = (should_crossover(randgen) < p_crossover) ? crossover(parent1, parent2) : make_pair(parent1, parent2);
-            if (should_mutate(randgen) < p_mutation) {
-                child1 = mutation(child1);
+            auto parent1 = population.at(select(population_fit, rng));
+            auto parent2 = population.at(select(population_fit, rng));
+            auto [child1, child2] = (should_crossover(rng) < p_crossover) ? crossover(parent1, parent2, rng) : make_pair(parent1, parent2);
+            if (should_mutate(rng) < p_mutation) {
+                child1 = mutation(child1, rng);
             }
-            if (should_mutate(randgen) < p_mutation) {
-                child2 = mutation(child2);
+            if (should_mutate(rng) < p_mutation) {
+                child2 = mutation(child2, rng);
             }
             new_pop[c + 0] = child1;
             new_pop[c + 1] = child2;
@@ -51,6 +51,8 @@ int main(int argc, char** argv)
     for (auto [k, v] : args_to_map(vector<string>(argv, argv + argc))) {
         parameters[k] = v; // overwrite default parameters with the ones from CLI
     }
+    unsigned long seed = parameters.count("seed") ? stoul(parameters["seed"]) : random_device()();
+    seed_random_generator(seed);
     vector<pair<double, double>> cities_coordinates;
     auto problem = generate_random_problem(stoi(parameters["size"]),
         [&cities_coordinates](auto coords) { cities_coordinates = coords; });
@@ -87,9 +89,6 @@ int main(int argc, char** argv)
             iterations,
             stoi(parameters["tabu_size"]), on_finish, on_step);
     } else if (parameters["method"] == "genetic_algorithm") {
-        random_device dandom_dev;
-        mt19937 rand_gen(dandom_dev());
-
         int n = stof(parameters["pop_size"]);
         vector<work_point_t> population(n);
         generate(population.begin(), population.end(), [&problem]() { return generate_random_tsp_point(problem); });
@@ -99,15 +98,15 @@ int main(int argc, char** argv)
         };
         double p_crossover = stof(parameters["p_crossover"]);
         double p_mutation = stof(parameters["p_mutation"]);
-        auto selection = [&](auto population_fit) {
+        auto selection = [&](auto population_fit, auto& rng) {
             uniform_int_distribution<int> distr(0, population_fit.size() - 1);
-            int a = distr(rand_gen), b = distr(rand_gen);
+            int a = distr(rng), b = distr(rng);
             return (population_fit[a] > population_fit[b]) ? a : b;
         };
-        auto crossover_pmx = [&](auto parent0, auto parent1) {
+        auto crossover_pmx = [&](auto parent0, auto parent1, auto& rng) {
             if (parent0.size() != parent1.size()) throw std::invalid_argument("both specimens should have the same size");
             uniform_int_distribution<int> distr(1, parent0.size() - 2);
-            int a = distr(rand_gen), b = distr(rand_gen); // punkty podzialu
+            int a = distr(rng), b = distr(rng); // punkty podzialu
             if (a > b) swap(a, b);
             if (a == b) return make_pair(parent0, parent1);
             auto child0 = parent1;
@@ -136,14 +135,14 @@ int main(int argc, char** argv)
             }
             return make_pair(child0, child1);
         };
-        auto mutation = [&](auto specimen) {
+        auto mutation = [&](auto specimen, auto& rng) {
             uniform_int_distribution<int> distr(0, specimen.size() - 1);
-            int a = distr(rand_gen);
-            int b = distr(rand_gen);
+            int a = distr(rng);
+            int b = distr(rng);
             std::swap(specimen[a], specimen[b]);
             return specimen;
         };
-        auto result_population = genetic_algorithm(fitness, population, term_condition, selection, crossover_pmx, p_crossover, mutation, p_mutation, on_finish, on_step);
+        auto result_population = genetic_algorithm(fitness, population, term_condition, selection, crossover_pmx, p_crossover, mutation, p_mutation, seed, on_finish, on_step);
         best_solution = result_population[0];
     }
 
@@ -13,6 +13,11 @@ using namespace std;
 random_device dandom_dev;
 mt19937 rand_gen(dandom_dev());
 
+void seed_random_generator(unsigned long seed)
+{
+    rand_gen.seed(seed);
+}
+
 
 
 
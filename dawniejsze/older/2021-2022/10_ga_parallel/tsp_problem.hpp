@@ -2,6 +2,8 @@
 #define __TSP_PROBLEM_IMPLEMENTATION___
 
 #include <functional>
+#include <iostream>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -19,6 +21,11 @@ using work_point_t = std::vector<int>;
  * */
 std::function<double(work_point_t)> cost_function_factory(my_graph_t tsp_problem);
 
+/**
+ * seeds the generator used by the random functions below, for reproducible runs
+ * */
+void seed_random_generator(unsigned long seed);
+
 /**
  * this generates random problem (set of cities) for TSP
  *
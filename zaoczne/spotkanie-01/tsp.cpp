@@ -3,12 +3,15 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <memory>
 #include <numeric>
 #include <random>
 #include <string>
 #include <vector>
 #include <iomanip>
+#include <limits>
+#include <utility>
 
 using vec2d = std::array<double, 2>;
 
@@ -133,15 +136,100 @@ solution_t random_hillclimb(solution_t solution)
     return solution;
 }
 
+/**
+ * Minimal 2-d tree with removal of points, for the nearest neighbour heuristic.
+ *
+ * The tree is implicit - the middle of every range of the points array is the splitting node.
+ * alive counts the points that remain in the subtree, so the emptied parts are skipped.
+ */
+class kd_tree_t
+{
+public:
+    explicit kd_tree_t(const problem_t& problem) : points(problem.size()), index(problem.size()),
+                                                   position(problem.size()), split(problem.size()),
+                                                   removed(problem.size(), 0), alive(problem.size())
+    {
+        std::vector<std::pair<vec2d, int>> entries(problem.size());
+        for (int i = 0; i < problem.size(); i++)
+            entries[i] = {problem[i], i};
+        build(entries, 0, entries.size(), 0);
+        for (int i = 0; i < entries.size(); i++) {
+            points[i] = entries[i].first;
+            index[i] = entries[i].second;
+            position[index[i]] = i;
+        }
+    }
+
+    int nearest(vec2d q) const
+    {
+        std::pair<double, int> best = {std::numeric_limits<double>::infinity(), -1};
+        nearest(0, points.size(), q, best);
+        return best.second;
+    }
+
+    void remove(int city)
+    {
+        int p = position[city];
+        removed[p] = 1;
+        for (int lo = 0, hi = points.size(); lo < hi;) {
+            int mid = lo + (hi - lo - 1) / 2;
+            alive[mid]--;
+            if (p == mid) break;
+            if (p < mid) hi = mid;
+            else lo = mid + 1;
+        }
+    }
+
+private:
+    void build(std::vector<std::pair<vec2d, int>>& entries, int lo, int hi, int d)
+    {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo - 1) / 2;
+        std::nth_element(entries.begin() + lo, entries.begin() + mid, entries.begin() + hi,
+            [d](auto& a, auto& b) { return a.first[d] < b.first[d]; });
+        split[mid] = d;
+        alive[mid] = hi - lo;
+        build(entries, lo, mid, 1 - d);
+        build(entries, mid + 1, hi, 1 - d);
+    }
+
+    void nearest(int lo, int hi, vec2d q, std::pair<double, int>& best) const
+    {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo - 1) / 2;
+        if (alive[mid] == 0) return;
+        if (!removed[mid]) {
+            vec2d v = q - points[mid];
+            double d2 = v[0] * v[0] + v[1] * v[1];
+            if (d2 < best.first) best = {d2, index[mid]};
+        }
+        double diff = q[split[mid]] - points[mid][split[mid]];
+        if (diff < 0) {
+            nearest(lo, mid, q, best);
+            if (diff * diff < best.first) nearest(mid + 1, hi, q, best);
+        } else {
+            nearest(mid + 1, hi, q, best);
+            if (diff * diff < best.first) nearest(lo, mid, q, best);
+        }
+    }
+
+    std::vector<vec2d> points;
+    std::vector<int> index;
+    std::vector<int> position;
+    std::vector<char> split;
+    std::vector<char> removed;
+    std::vector<int> alive;
+};
+
 solution_t shortest_distance(solution_t solution)
 {
     solution_t result = solution;
     auto& problem = *solution.problem;
-    solution.erase(solution.begin());
+    kd_tree_t unvisited(problem);
+    unvisited.remove(result[0]);
     for (int i = 1; i < result.size(); i++) {
-        auto found = std::min_element(solution.begin(), solution.end(), [&](auto a, auto b) {                    double dist_a = len(problem[result[i-1]] - problem[a]);                    double dist_b = len(problem[result[i-1]] - problem[b]);                    return dist_a < dist_b; });
-        result[i] = *found;
-        solution.erase(found);
+        result[i] = unvisited.nearest(problem[result[i - 1]]);
+        unvisited.remove(result[i]);
     }
     return result;
 }
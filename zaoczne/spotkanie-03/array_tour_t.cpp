@@ -0,0 +1,30 @@
+#include "array_tour_t.h"
+
+#include <utility>
+
+namespace mhe {
+
+    array_tour_t::array_tour_t(const std::vector<int> &cities) : tour(cities), position(cities.size()) {
+        for (int i = 0; i < size(); i++) position[tour[i]] = i;
+    }
+
+    void array_tour_t::reverse(int a, int b) {
+        const int n = size();
+        int i = position[a], j = position[b];
+        int length = (j - i + n) % n + 1;
+        if (2 * length > n) {
+            std::swap(i, j);
+            i = (i + 1) % n;
+            j = (j + n - 1) % n;
+            length = n - length;
+        }
+        for (int k = 0; k < length / 2; k++) {
+            std::swap(tour[i], tour[j]);
+            position[tour[i]] = i;
+            position[tour[j]] = j;
+            i = (i + 1 == n) ? 0 : i + 1;
+            j = (j == 0) ? n - 1 : j - 1;
+        }
+    }
+
+} // mhe
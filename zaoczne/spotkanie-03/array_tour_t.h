@@ -0,0 +1,50 @@
+#ifndef MHE_ARRAY_TOUR_T_H
+#define MHE_ARRAY_TOUR_T_H
+
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Tour stored as the array of cities together with the position of every city.
+     *
+     * next, prev and between are O(1). reverse flips the shorter of the two paths, so it costs
+     * at most n/2 swaps. Reversing the other side gives the same cycle, only the orientation
+     * differs, so the callers must ask next/prev again after every reverse.
+     */
+    class array_tour_t {
+    public:
+        explicit array_tour_t(const std::vector<int> &cities);
+
+        int size() const { return tour.size(); }
+
+        int next(int c) const {
+            int p = position[c] + 1;
+            return tour[(p == size()) ? 0 : p];
+        }
+
+        int prev(int c) const {
+            int p = position[c];
+            return tour[(p == 0) ? size() - 1 : p - 1];
+        }
+
+        /// true if b lies on the path going forward from a to c (inclusive)
+        bool between(int a, int b, int c) const {
+            int pa = position[a], pb = position[b], pc = position[c];
+            if (pa <= pc) return (pa <= pb) && (pb <= pc);
+            return (pb >= pa) || (pb <= pc);
+        }
+
+        /// reverses the path going forward from a to b
+        void reverse(int a, int b);
+
+        const std::vector<int> &cities() const { return tour; }
+
+    private:
+        std::vector<int> tour;
+        std::vector<int> position;
+    };
+
+} // mhe
+
+#endif //MHE_ARRAY_TOUR_T_H
@@ -0,0 +1,27 @@
+#include "candidate_lists_t.h"
+
+#include "kd_tree_t.h"
+
+#include <algorithm>
+
+namespace mhe {
+
+    candidate_lists_t::candidate_lists_t(const problem_t &problem, int k) {
+        const int n = problem.size();
+        width = std::max(0, std::min(k, n - 1));
+        neighbours.resize(std::size_t(n) * width);
+        neighbour_distances.resize(std::size_t(n) * width);
+
+        kd_tree_t tree(problem);
+        for (int c = 0; c < n; c++) {
+            int i = 0;
+            for (int e: tree.k_nearest(problem[c], width + 1)) {
+                if ((e == c) || (i == width)) continue;
+                neighbours[std::size_t(c) * width + i] = e;
+                neighbour_distances[std::size_t(c) * width + i] = problem.distance(c, e);
+                i++;
+            }
+        }
+    }
+
+} // mhe
@@ -0,0 +1,40 @@
+#ifndef MHE_CANDIDATE_LISTS_T_H
+#define MHE_CANDIDATE_LISTS_T_H
+
+#include "problem_t.h"
+
+#include <span>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * The k nearest neighbours of every city, sorted from the closest one.
+     *
+     * Local search engines consider only the edges to these cities, which is what makes them
+     * scale to large instances.
+     */
+    class candidate_lists_t {
+    public:
+        candidate_lists_t(const problem_t &problem, int k);
+
+        int k() const { return width; }
+
+        std::span<const int> operator[](int city) const {
+            return {neighbours.data() + std::size_t(city) * width, std::size_t(width)};
+        }
+
+        /// distances to the neighbours, in the same order as operator[]
+        std::span<const double> distances(int city) const {
+            return {neighbour_distances.data() + std::size_t(city) * width, std::size_t(width)};
+        }
+
+    private:
+        int width;
+        std::vector<int> neighbours;
+        std::vector<double> neighbour_distances;
+    };
+
+} // mhe
+
+#endif //MHE_CANDIDATE_LISTS_T_H
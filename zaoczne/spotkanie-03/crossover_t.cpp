@@ -0,0 +1,174 @@
+#include "crossover_t.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace mhe {
+
+    crossover_t::kind_t crossover_t::kind_of(const std::string &name) {
+        if (name == "pmx") return kind_t::pmx;
+        if (name == "ox") return kind_t::ox;
+        if (name == "cx") return kind_t::cx;
+        if (name == "erx") return kind_t::erx;
+        throw std::invalid_argument("unknown crossover " + name);
+    }
+
+    crossover_t::crossover_t(int cities) :
+            mapping{std::vector<int>(cities, -1), std::vector<int>(cities, -1)},
+            used(cities, 0), position(cities), edges(4 * cities), edge_count(cities),
+            unused(cities), unused_at(cities) {
+    }
+
+    void crossover_t::operator()(kind_t kind, std::span<const int> a, std::span<const int> b, std::span<int> c,
+                                 std::span<int> d, std::mt19937 &rgen) {
+        switch (kind) {
+            case kind_t::pmx:
+                pmx(a, b, c, d, rgen);
+                break;
+            case kind_t::ox:
+                ox(a, b, c, d, rgen);
+                break;
+            case kind_t::cx:
+                cx(a, b, c, d, rgen);
+                break;
+            case kind_t::erx:
+                erx(a, b, c, d, rgen);
+                break;
+        }
+    }
+
+    void crossover_t::pmx(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                          std::mt19937 &rgen) {
+        std::copy(a.begin(), a.end(), c.begin());
+        std::copy(b.begin(), b.end(), d.begin());
+        const int n = c.size();
+        std::uniform_int_distribution<int> distr(0, n - 1);
+        int cuts[2] = {distr(rgen), distr(rgen)};
+        if (cuts[0] == cuts[1]) return;
+        if (cuts[0] > cuts[1]) std::swap(cuts[0], cuts[1]);
+
+        for (int i = cuts[0]; i < cuts[1]; i++) {
+            std::swap(c[i], d[i]);
+            mapping[0][c[i]] = d[i];
+            mapping[1][d[i]] = c[i];
+        }
+        for (int i = 0; i < n; i++) {
+            if (i == cuts[0]) {
+                i = cuts[1] - 1;
+                continue;
+            }
+            while (mapping[0][c[i]] >= 0) c[i] = mapping[0][c[i]];
+            while (mapping[1][d[i]] >= 0) d[i] = mapping[1][d[i]];
+        }
+        for (int i = cuts[0]; i < cuts[1]; i++) {
+            mapping[0][c[i]] = -1;
+            mapping[1][d[i]] = -1;
+        }
+    }
+
+    void crossover_t::ox(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                         std::mt19937 &rgen) {
+        std::uniform_int_distribution<int> distr(0, c.size() - 1);
+        int cuts[2] = {distr(rgen), distr(rgen)};
+        if (cuts[0] > cuts[1]) std::swap(cuts[0], cuts[1]);
+        order_fill(a, b, c, cuts[0], cuts[1]);
+        order_fill(b, a, d, cuts[0], cuts[1]);
+    }
+
+    void crossover_t::order_fill(std::span<const int> a, std::span<const int> b, std::span<int> c, int from,
+                                 int to) {
+        const int n = c.size();
+        for (int i = from; i < to; i++) {
+            c[i] = a[i];
+            used[a[i]] = 1;
+        }
+        // the free positions from the second cut on, wrapping around, get the cities of b in the order from the cut
+        int k = to % n;
+        for (int j = 0; j < n; j++) {
+            int city = b[(to + j) % n];
+            if (used[city]) continue;
+            c[k] = city;
+            k = (k + 1) % n;
+        }
+        for (int i = from; i < to; i++) used[a[i]] = 0;
+    }
+
+    void crossover_t::cx(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                         std::mt19937 &) {
+        const int n = a.size();
+        for (int i = 0; i < n; i++) position[a[i]] = i;
+        // here used marks the positions already in some cycle; every other cycle comes from the other parent
+        int cycle = 0;
+        for (int start = 0; start < n; start++) {
+            if (used[start]) continue;
+            for (int i = start; !used[i]; i = position[b[i]]) {
+                used[i] = 1;
+                c[i] = (cycle % 2) ? b[i] : a[i];
+                d[i] = (cycle % 2) ? a[i] : b[i];
+            }
+            cycle++;
+        }
+        std::fill(used.begin(), used.end(), 0);
+    }
+
+    void crossover_t::erx(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                          std::mt19937 &rgen) {
+        edge_child(a, b, c, rgen);
+        edge_child(b, a, d, rgen);
+    }
+
+    void crossover_t::edge_child(std::span<const int> a, std::span<const int> b, std::span<int> c,
+                                 std::mt19937 &rgen) {
+        const int n = a.size();
+        std::fill(edge_count.begin(), edge_count.end(), 0);
+        auto add_edge = [this](int x, int y) {
+            for (int k = 0; k < edge_count[x]; k++)
+                if (edges[4 * x + k] == y) return;
+            edges[4 * x + edge_count[x]++] = y;
+        };
+        for (auto p: {a, b})
+            for (int i = 0; i < n; i++) {
+                add_edge(p[i], p[(i + 1) % n]);
+                add_edge(p[(i + 1) % n], p[i]);
+            }
+        std::iota(unused.begin(), unused.end(), 0);
+        std::iota(unused_at.begin(), unused_at.end(), 0);
+        int remaining = n;
+        // removes the city from the unused list and from the edge lists of its neighbours
+        auto take = [&](int city) {
+            int last = unused[--remaining];
+            unused[unused_at[city]] = last;
+            unused_at[last] = unused_at[city];
+            for (int k = 0; k < edge_count[city]; k++) {
+                int neighbour = edges[4 * city + k];
+                int *list = &edges[4 * neighbour];
+                auto found = std::find(list, list + edge_count[neighbour], city);
+                *found = list[--edge_count[neighbour]];
+            }
+        };
+
+        int current = a[0];
+        for (int i = 0; i < n; i++) {
+            c[i] = current;
+            take(current);
+            if (remaining == 0) break;
+            // the neighbour with the fewest edges left, ties are broken at random
+            int next = -1, fewest = 5, ties = 0;
+            for (int k = 0; k < edge_count[current]; k++) {
+                int neighbour = edges[4 * current + k];
+                if (edge_count[neighbour] < fewest) {
+                    next = neighbour;
+                    fewest = edge_count[neighbour];
+                    ties = 1;
+                } else if ((edge_count[neighbour] == fewest) &&
+                           (std::uniform_int_distribution<int>(0, ties++)(rgen) == 0)) {
+                    next = neighbour;
+                }
+            }
+            if (next < 0) next = unused[std::uniform_int_distribution<int>(0, remaining - 1)(rgen)];
+            current = next;
+        }
+    }
+
+} // mhe
@@ -0,0 +1,64 @@
+#ifndef MHE_CROSSOVER_T_H
+#define MHE_CROSSOVER_T_H
+
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Crossovers of permutations: PMX, OX, cycle crossover and edge recombination.
+     *
+     * The parents a and b give the children c and d. All of them are rows of the same length
+     * and the children must not overlap with the parents. The bookkeeping is done in arrays
+     * indexed by the city, allocated once in the constructor, so every crossover is O(n)
+     * and does not touch the heap. One object must not be used by two threads at once.
+     */
+    class crossover_t {
+    public:
+        enum class kind_t {
+            pmx, ox, cx, erx
+        };
+        /// the kind for the name pmx, ox, cx or erx
+        static kind_t kind_of(const std::string &name);
+
+        explicit crossover_t(int cities);
+        int cities() const { return used.size(); }
+
+        void operator()(kind_t kind, std::span<const int> a, std::span<const int> b, std::span<int> c,
+                        std::span<int> d, std::mt19937 &rgen);
+
+        /// partially mapped crossover, the segment between two cuts is swapped and the rest is repaired by the mapping
+        void pmx(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                 std::mt19937 &rgen);
+        /// order crossover, the segment stays and the rest is filled in the order of the other parent
+        void ox(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                std::mt19937 &rgen);
+        /// cycle crossover, every city keeps the position it has in one of the parents
+        void cx(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                std::mt19937 &rgen);
+        /// edge recombination, the children are built mostly from the edges of the parents
+        void erx(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                 std::mt19937 &rgen);
+
+    private:
+        void order_fill(std::span<const int> a, std::span<const int> b, std::span<int> c, int from, int to);
+        void edge_child(std::span<const int> a, std::span<const int> b, std::span<int> c, std::mt19937 &rgen);
+
+        /// PMX mapping of the cities from the swapped segment, -1 when not mapped
+        std::vector<int> mapping[2];
+        std::vector<char> used;
+        std::vector<int> position;
+        /// up to 4 neighbours of every city in the edge recombination
+        std::vector<int> edges;
+        std::vector<int> edge_count;
+        /// cities not yet in the child, with the position of every city on this list
+        std::vector<int> unused;
+        std::vector<int> unused_at;
+    };
+
+} // mhe
+
+#endif //MHE_CROSSOVER_T_H
@@ -0,0 +1,46 @@
+#include "distance_matrix_t.h"
+
+#include <algorithm>
+
+namespace mhe {
+
+    template<class precision_t>
+    std::shared_ptr<const distance_matrix_t<precision_t>> distance_matrix_t<precision_t>::build(const std::vector<vec2d> &points) {
+        const std::size_t n = points.size();
+        const std::size_t per_line = cache_line / sizeof(value_t);
+        const std::size_t stride = (n + per_line - 1) / per_line * per_line;
+        const std::size_t triangle = n * (n + 1) / 2;
+
+        auto matrix = std::make_shared<distance_matrix_t>();
+        matrix->n = n;
+        std::size_t elements;
+        if (n * stride * sizeof(value_t) <= max_bytes) {
+            matrix->matrix_layout = layout_t::full;
+            matrix->stride = stride;
+            elements = n * stride;
+        } else if (triangle * sizeof(value_t) <= max_bytes) {
+            matrix->matrix_layout = layout_t::triangular;
+            elements = triangle;
+        } else {
+            return nullptr;
+        }
+        matrix->data.reset(static_cast<value_t *>(
+                ::operator new[](std::max<std::size_t>(elements, 1) * sizeof(value_t), std::align_val_t(cache_line))));
+
+        value_t *d = matrix->data.get();
+        for (std::size_t i = 0; i < n; i++) {
+            if (matrix->matrix_layout == layout_t::full) {
+                for (std::size_t j = 0; j < n; j++) d[i * stride + j] = precision_t::of(len(points[i] - points[j]));
+                for (std::size_t j = n; j < stride; j++) d[i * stride + j] = 0;
+            } else {
+                for (std::size_t j = 0; j <= i; j++) d[i * (i + 1) / 2 + j] = precision_t::of(len(points[i] - points[j]));
+            }
+        }
+        return matrix;
+    }
+
+    template class distance_matrix_t<double_precision_t>;
+    template class distance_matrix_t<float_precision_t>;
+    template class distance_matrix_t<int32_precision_t>;
+
+} // mhe
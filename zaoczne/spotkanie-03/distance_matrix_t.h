@@ -0,0 +1,62 @@
+#ifndef MHE_DISTANCE_MATRIX_T_H
+#define MHE_DISTANCE_MATRIX_T_H
+
+#include "precision_t.h"
+#include "vec2d.h"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Precomputed distances between every pair of cities.
+     *
+     * The table is one contiguous block aligned to the cache line. Small instances get the
+     * full n x n matrix with rows padded to the cache line, bigger ones only the packed lower
+     * triangle (the euclidean distance is symmetric). If even the triangle does not fit in
+     * max_bytes, build returns nullptr and the caller should compute distances on the fly.
+     * The entries are precision_t::value_t, so float and int32 tables take half the memory.
+     */
+    template<class precision_t = distance_precision_t>
+    class distance_matrix_t {
+    public:
+        enum class layout_t {
+            full, triangular
+        };
+
+        static constexpr std::size_t cache_line = 64;
+        /// memory limit for the table, above it the distances are not cached
+        static inline std::size_t max_bytes = std::size_t(1) << 30;
+
+        using value_t = typename precision_t::value_t;
+
+        static std::shared_ptr<const distance_matrix_t> build(const std::vector<vec2d> &points);
+
+        value_t operator()(int a, int b) const {
+            if (matrix_layout == layout_t::full) return data[std::size_t(a) * stride + b];
+            if (a < b) std::swap(a, b);
+            return data[std::size_t(a) * (a + 1) / 2 + b];
+        }
+
+        std::size_t size() const { return n; }
+
+        layout_t layout() const { return matrix_layout; }
+
+    private:
+        struct aligned_delete_t {
+            void operator()(value_t *p) const { ::operator delete[](p, std::align_val_t(cache_line)); }
+        };
+
+        std::size_t n = 0;
+        std::size_t stride = 0;
+        layout_t matrix_layout = layout_t::full;
+        std::unique_ptr<value_t[], aligned_delete_t> data;
+    };
+
+} // mhe
+
+#endif //MHE_DISTANCE_MATRIX_T_H
@@ -0,0 +1,225 @@
+#include "eax_t.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace mhe {
+
+    namespace {
+        void remove_edge(std::vector<int> &rest, std::vector<int> &count, int x, int y) {
+            for (int k = 0; k < count[x]; k++)
+                if (rest[2 * x + k] == y) {
+                    rest[2 * x + k] = rest[2 * x + --count[x]];
+                    return;
+                }
+        }
+
+        void replace_link(std::vector<int> &link, int x, int from, int to) {
+            if (link[2 * x] == from) link[2 * x] = to;
+            else link[2 * x + 1] = to;
+        }
+    }
+
+    eax_t::eax_t(const problem_t &problem_, const candidate_lists_t &candidates_) :
+            problem(problem_), candidates(candidates_), n(problem_.size()),
+            link(2 * n), b_link(2 * n), rest{std::vector<int>(2 * n), std::vector<int>(2 * n)},
+            rest_count{std::vector<int>(n), std::vector<int>(n)}, last_at(2 * n, -1), sub_tour_of(n) {
+        path.reserve(2 * n + 1);
+        cycle_vertices.reserve(3 * n);
+        cycle_start.reserve(n + 1);
+        cycle_a_first.reserve(n);
+        selected.reserve(n);
+        sub_tours.reserve(n);
+    }
+
+    double eax_t::operator()(std::span<const int> a, double goal_a, std::span<const int> b, std::span<int> c,
+                             std::mt19937 &rgen) {
+        std::copy(a.begin(), a.end(), c.begin());
+        if (n < 5) return goal_a;
+        for (int i = 0; i < n; i++) {
+            link[2 * a[i]] = a[(i + n - 1) % n];
+            link[2 * a[i] + 1] = a[(i + 1) % n];
+            b_link[2 * b[i]] = b[(i + n - 1) % n];
+            b_link[2 * b[i] + 1] = b[(i + 1) % n];
+        }
+        build_ab_cycles(rgen);
+        int cycles = cycle_start.size() - 1;
+        if (cycles == 0) return goal_a;
+
+        selected.clear();
+        if (strategy == strategy_t::rand)
+            for (int i = 0; i < cycles; i++)
+                if (rgen() & 1) selected.push_back(i);
+        if (selected.empty())
+            selected.push_back(std::uniform_int_distribution<int>(0, cycles - 1)(rgen));
+
+        double goal = goal_a;
+        for (int i: selected) goal += apply_cycle(i);
+        find_sub_tours();
+        goal += merge_sub_tours();
+
+        for (int i = 1, prev = link[2 * c[0]]; i < n; i++) {
+            int current = c[i - 1];
+            c[i] = (link[2 * current] != prev) ? link[2 * current] : link[2 * current + 1];
+            prev = current;
+        }
+        return goal;
+    }
+
+    void eax_t::build_ab_cycles(std::mt19937 &rgen) {
+        for (int v = 0; v < n; v++) {
+            for (int e = 0; e < 2; e++) {
+                auto &own = e ? b_link : link;
+                auto &other = e ? link : b_link;
+                rest_count[e][v] = 0;
+                for (int k = 0; k < 2; k++) {
+                    int w = own[2 * v + k];
+                    if ((other[2 * v] != w) && (other[2 * v + 1] != w))
+                        rest[e][2 * v + rest_count[e][v]++] = w;
+                }
+            }
+        }
+        cycle_vertices.clear();
+        cycle_start.assign(1, 0);
+        cycle_a_first.clear();
+        // the walk takes an A edge from the cities at even positions of the path and a B edge from the odd ones;
+        // when it comes back to a city with the same parity, the part of the path in between is an AB-cycle
+        int offset = std::uniform_int_distribution<int>(0, n - 1)(rgen);
+        for (int s = 0; s < n; s++) {
+            int start = (offset + s) % n;
+            if (rest_count[0][start] == 0) continue;
+            path.assign(1, start);
+            last_at[2 * start] = 0;
+            while (true) {
+                int k = path.size() - 1;
+                int u = path[k];
+                int e = k % 2;
+                if (rest_count[e][u] == 0) break;
+                int w = rest[e][2 * u + (rest_count[e][u] > 1 ? (rgen() & 1) : 0)];
+                remove_edge(rest[e], rest_count[e], u, w);
+                remove_edge(rest[e], rest_count[e], w, u);
+                int p = (k + 1) % 2;
+                int j = last_at[2 * w + p];
+                if (j < 0) {
+                    path.push_back(w);
+                    last_at[2 * w + p] = k + 1;
+                    continue;
+                }
+                cycle_vertices.insert(cycle_vertices.end(), path.begin() + j, path.end());
+                cycle_vertices.push_back(w);
+                cycle_start.push_back(cycle_vertices.size());
+                cycle_a_first.push_back(j % 2 == 0);
+                for (int i = j + 1; i <= k; i++) last_at[2 * path[i] + i % 2] = -1;
+                path.resize(j + 1);
+            }
+            for (int i = 0, length = path.size(); i < length; i++) last_at[2 * path[i] + i % 2] = -1;
+        }
+    }
+
+    double eax_t::apply_cycle(int cycle) {
+        double delta = 0;
+        int first = cycle_start[cycle], last = cycle_start[cycle + 1] - 1;
+        // first every vertex loses its A edges, then the B edges take the freed places
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = first; i < last; i++) {
+                bool a_edge = ((i - first) % 2 == 0) == (bool) cycle_a_first[cycle];
+                if (a_edge != (pass == 0)) continue;
+                int x = cycle_vertices[i], y = cycle_vertices[i + 1];
+                if (a_edge) {
+                    replace_link(link, x, y, -1);
+                    replace_link(link, y, x, -1);
+                    delta -= problem.distance(x, y);
+                } else {
+                    replace_link(link, x, -1, y);
+                    replace_link(link, y, -1, x);
+                    delta += problem.distance(x, y);
+                }
+            }
+        }
+        return delta;
+    }
+
+    void eax_t::find_sub_tours() {
+        std::fill(sub_tour_of.begin(), sub_tour_of.end(), -1);
+        sub_tours.clear();
+        for (int v = 0; v < n; v++) {
+            if (sub_tour_of[v] >= 0) continue;
+            int id = sub_tours.size();
+            int size = 0;
+            for (int prev = link[2 * v], current = v; sub_tour_of[current] < 0; size++) {
+                sub_tour_of[current] = id;
+                int next = (link[2 * current] != prev) ? link[2 * current] : link[2 * current + 1];
+                prev = current;
+                current = next;
+            }
+            sub_tours.push_back({v, size});
+        }
+    }
+
+    double eax_t::merge_sub_tours() {
+        double delta = 0;
+        const int tours = sub_tours.size();
+        for (int left = tours; left > 1; left--) {
+            int u_id = -1;
+            for (int i = 0; i < tours; i++)
+                if ((sub_tours[i].size > 0) && ((u_id < 0) || (sub_tours[i].size < sub_tours[u_id].size)))
+                    u_id = i;
+
+            // remove (u, un) and (v, vn), add (u, v) and (un, vn) or, when crossed, (u, vn) and (un, v)
+            double best = std::numeric_limits<double>::infinity();
+            int best_u = -1, best_un = -1, best_v = -1, best_vn = -1;
+            bool best_crossed = false;
+            auto consider = [&](int u, int v) {
+                for (int i = 0; i < 2; i++) {
+                    int un = link[2 * u + i];
+                    for (int j = 0; j < 2; j++) {
+                        int vn = link[2 * v + j];
+                        double removed = problem.distance(u, un) + problem.distance(v, vn);
+                        double straight = problem.distance(u, v) + problem.distance(un, vn) - removed;
+                        double crossed = problem.distance(u, vn) + problem.distance(un, v) - removed;
+                        if (std::min(straight, crossed) < best) {
+                            best = std::min(straight, crossed);
+                            best_u = u, best_un = un, best_v = v, best_vn = vn;
+                            best_crossed = crossed < straight;
+                        }
+                    }
+                }
+            };
+            auto for_each_in_u = [&](auto f) {
+                int start = sub_tours[u_id].city;
+                for (int prev = link[2 * start], current = start, i = 0; i < sub_tours[u_id].size; i++) {
+                    f(current);
+                    int next = (link[2 * current] != prev) ? link[2 * current] : link[2 * current + 1];
+                    prev = current;
+                    current = next;
+                }
+            };
+            for_each_in_u([&](int u) {
+                for (int v: candidates[u])
+                    if (sub_tour_of[v] != u_id) consider(u, v);
+            });
+            if (best_u < 0) {
+                // no candidate leads out of the sub-tour, so look at every city
+                for_each_in_u([&](int u) {
+                    for (int v = 0; v < n; v++)
+                        if (sub_tour_of[v] != u_id) consider(u, v);
+                });
+            }
+
+            int v_id = sub_tour_of[best_v];
+            for_each_in_u([&](int u) { sub_tour_of[u] = v_id; });
+            sub_tours[v_id].size += sub_tours[u_id].size;
+            sub_tours[u_id].size = 0;
+
+            int v_end = best_crossed ? best_vn : best_v;
+            int vn_end = best_crossed ? best_v : best_vn;
+            replace_link(link, best_u, best_un, v_end);
+            replace_link(link, best_un, best_u, vn_end);
+            replace_link(link, best_v, best_vn, best_crossed ? best_un : best_u);
+            replace_link(link, best_vn, best_v, best_crossed ? best_u : best_un);
+            delta += best;
+        }
+        return delta;
+    }
+
+} // mhe
@@ -0,0 +1,75 @@
+#ifndef MHE_EAX_T_H
+#define MHE_EAX_T_H
+
+#include "candidate_lists_t.h"
+#include "problem_t.h"
+
+#include <random>
+#include <span>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Edge assembly crossover (EAX) of two tours.
+     *
+     * The edges of the parents that are not common are split into AB-cycles, which take
+     * an edge of A and an edge of B in turns. Some of the AB-cycles (the E-set) are applied
+     * to A: their A edges are removed and their B edges are added. That leaves A cut into
+     * sub-tours, which are merged, the smallest first, by the cheapest exchange of two edges
+     * found through the candidate lists. The goal of the child is the goal of A plus the
+     * lengths of the changed edges, so the child does not have to be evaluated.
+     *
+     * All buffers are allocated in the constructor and one child costs O(n) apart from the
+     * merging. One object must not be used by two threads at once.
+     */
+    class eax_t {
+    public:
+        /// single - one random AB-cycle, rand - every AB-cycle with the probability 1/2
+        enum class strategy_t {
+            single, rand
+        };
+
+        eax_t(const problem_t &problem_, const candidate_lists_t &candidates_);
+
+        const problem_t &problem;
+        const candidate_lists_t &candidates;
+        strategy_t strategy = strategy_t::single;
+
+        /// writes the child of a and b to c and returns its goal, goal_a must be the goal of a
+        double operator()(std::span<const int> a, double goal_a, std::span<const int> b, std::span<int> c,
+                          std::mt19937 &rgen);
+
+    private:
+        void build_ab_cycles(std::mt19937 &rgen);
+        double apply_cycle(int cycle);
+        void find_sub_tours();
+        double merge_sub_tours();
+
+        int n;
+        /// the two neighbours of every city in the intermediate solution, -1 for a removed edge
+        std::vector<int> link;
+        std::vector<int> b_link;
+        /// the edges of A and B that are not common and are not yet in an AB-cycle
+        std::vector<int> rest[2];
+        std::vector<int> rest_count[2];
+        std::vector<int> path;
+        /// the index in path where the city was with the given parity, -1 if not there
+        std::vector<int> last_at;
+        /// the vertices of every AB-cycle, the first vertex repeated at the end
+        std::vector<int> cycle_vertices;
+        std::vector<int> cycle_start;
+        std::vector<char> cycle_a_first;
+        std::vector<int> selected;
+
+        struct sub_tour_t {
+            int city;
+            int size;
+        };
+        std::vector<int> sub_tour_of;
+        std::vector<sub_tour_t> sub_tours;
+    };
+
+} // mhe
+
+#endif //MHE_EAX_T_H
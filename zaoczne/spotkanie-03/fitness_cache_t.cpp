@@ -0,0 +1,61 @@
+#include "fitness_cache_t.h"
+
+#include <algorithm>
+
+namespace mhe {
+
+    fitness_cache_t::fitness_cache_t(std::size_t capacity) : sets(1), shards(new shard_t[shards_count]) {
+        while (sets * ways * shards_count < capacity) sets *= 2;
+        for (int i = 0; i < shards_count; i++) shards[i].entries.assign(sets * ways, {0, 0.0, 0});
+    }
+
+    bool fitness_cache_t::find(std::uint64_t key, double &value) {
+        auto &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        entry_t *e = set(s, key);
+        for (int i = 0; i < ways; i++) {
+            if ((e[i].used != 0) && (e[i].key == key)) {
+                e[i].used = ++s.clock;
+                value = e[i].value;
+                s.hits++;
+                return true;
+            }
+        }
+        s.misses++;
+        return false;
+    }
+
+    void fitness_cache_t::insert(std::uint64_t key, double value) {
+        auto &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        entry_t *e = set(s, key);
+        entry_t *victim = e;
+        for (int i = 0; i < ways; i++) {
+            if ((e[i].used != 0) && (e[i].key == key)) {
+                victim = e + i;
+                break;
+            }
+            if (e[i].used < victim->used) victim = e + i;
+        }
+        *victim = {key, value, ++s.clock};
+    }
+
+    std::uint64_t fitness_cache_t::hits() const {
+        std::uint64_t sum = 0;
+        for (int i = 0; i < shards_count; i++) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            sum += shards[i].hits;
+        }
+        return sum;
+    }
+
+    std::uint64_t fitness_cache_t::misses() const {
+        std::uint64_t sum = 0;
+        for (int i = 0; i < shards_count; i++) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            sum += shards[i].misses;
+        }
+        return sum;
+    }
+
+} // mhe
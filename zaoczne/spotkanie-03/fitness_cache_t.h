@@ -0,0 +1,74 @@
+#ifndef MHE_FITNESS_CACHE_T_H
+#define MHE_FITNESS_CACHE_T_H
+
+#include "solution_t.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Bounded fitness memo keyed by solution_t::hash, safe to use from many threads.
+     *
+     * The table is split into shards with their own locks. Every shard is set associative:
+     * a key can live in one set of `ways` entries, and a new key replaces the least recently
+     * used entry of its set. Only the 64-bit hash is stored, so two different tours with the
+     * same hash would share the fitness.
+     */
+    class fitness_cache_t {
+    public:
+        static constexpr int ways = 4;
+        static constexpr int shards_count = 64;
+
+        /// capacity is rounded up to whole sets in every shard
+        explicit fitness_cache_t(std::size_t capacity);
+
+        bool find(std::uint64_t key, double &value);
+        void insert(std::uint64_t key, double value);
+
+        /// cached fitness(solution)
+        template<class fitness_f>
+        double operator()(const solution_t &solution, fitness_f fitness) {
+            const auto key = solution.hash();
+            double value;
+            if (find(key, value)) return value;
+            value = fitness(solution);
+            insert(key, value);
+            return value;
+        }
+
+        std::size_t capacity() const { return std::size_t(shards_count) * sets * ways; }
+
+        std::uint64_t hits() const;
+        std::uint64_t misses() const;
+
+    private:
+        struct entry_t {
+            std::uint64_t key;
+            double value;
+            /// the last use, 0 for the empty entry
+            std::uint64_t used;
+        };
+        struct alignas(64) shard_t {
+            mutable std::mutex mutex;
+            std::vector<entry_t> entries;
+            std::uint64_t clock = 0;
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+        };
+
+        shard_t &shard(std::uint64_t key) { return shards[key % shards_count]; }
+
+        entry_t *set(shard_t &s, std::uint64_t key) { return s.entries.data() + ((key / shards_count) & (sets - 1)) * ways; }
+
+        std::size_t sets;
+        std::unique_ptr<shard_t[]> shards;
+    };
+
+} // mhe
+
+#endif //MHE_FITNESS_CACHE_T_H
@@ -0,0 +1,74 @@
+#ifndef MHE_INDEXED_HEAP_T_H
+#define MHE_INDEXED_HEAP_T_H
+
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Binary heap of the indices 0..n-1 ordered by keys stored outside of the heap.
+     *
+     * The heap remembers where every index is, so when the key of one index changes the
+     * order is restored in O(log n). Like std::priority_queue, with std::less the index
+     * with the largest key is on the top.
+     */
+    template<class compare_t = std::less<double>>
+    class indexed_heap_t {
+    public:
+        /// builds the heap over every index of keys in O(n), keys must outlive the heap
+        void assign(const std::vector<double> &keys_) {
+            keys = &keys_;
+            heap.resize(keys->size());
+            position.resize(keys->size());
+            std::iota(heap.begin(), heap.end(), 0);
+            std::iota(position.begin(), position.end(), 0);
+            for (int p = (int) heap.size() / 2 - 1; p >= 0; p--) down(p);
+        }
+
+        int top() const { return heap.front(); }
+
+        /// restores the order after the key of the index i has changed
+        void update(int i) {
+            up(position[i]);
+            down(position[i]);
+        }
+
+    private:
+        /// the element at heap position a should be above the one at b
+        bool above(int a, int b) const { return compare((*keys)[heap[b]], (*keys)[heap[a]]); }
+
+        void swap_at(int a, int b) {
+            std::swap(heap[a], heap[b]);
+            position[heap[a]] = a;
+            position[heap[b]] = b;
+        }
+
+        void up(int p) {
+            while ((p > 0) && above(p, (p - 1) / 2)) {
+                swap_at(p, (p - 1) / 2);
+                p = (p - 1) / 2;
+            }
+        }
+
+        void down(int p) {
+            const int n = heap.size();
+            for (int c = 2 * p + 1; c < n; c = 2 * p + 1) {
+                if ((c + 1 < n) && above(c + 1, c)) c++;
+                if (!above(c, p)) break;
+                swap_at(p, c);
+                p = c;
+            }
+        }
+
+        const std::vector<double> *keys = nullptr;
+        std::vector<int> heap;
+        std::vector<int> position;
+        compare_t compare;
+    };
+
+} // mhe
+
+#endif //MHE_INDEXED_HEAP_T_H
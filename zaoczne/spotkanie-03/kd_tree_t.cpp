@@ -0,0 +1,221 @@
+#include "kd_tree_t.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace mhe {
+
+    namespace {
+        double distance2(vec2d a, vec2d b) {
+            double dx = a[0] - b[0], dy = a[1] - b[1];
+            return dx * dx + dy * dy;
+        }
+    }
+
+    kd_tree_t::kd_tree_t(const std::vector<vec2d> &points_) :
+            points(points_.size()), index(points_.size()), position(points_.size()), split(points_.size()),
+            removed(points_.size(), 0), alive(points_.size()) {
+        if (points_.empty()) return;
+        std::vector<std::pair<vec2d, int>> entries(points_.size());
+        vec2d min_p = points_[0], max_p = points_[0];
+        for (std::size_t i = 0; i < points_.size(); i++) {
+            entries[i] = {points_[i], (int) i};
+            for (int d = 0; d < 2; d++) {
+                min_p[d] = std::min(min_p[d], points_[i][d]);
+                max_p[d] = std::max(max_p[d], points_[i][d]);
+            }
+        }
+        bounds_min = min_p;
+        bounds_max = max_p;
+        build(entries, 0, entries.size(), min_p, max_p);
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            points[i] = entries[i].first;
+            index[i] = entries[i].second;
+            position[index[i]] = i;
+        }
+    }
+
+    void kd_tree_t::build(std::vector<std::pair<vec2d, int>> &entries, int lo, int hi, vec2d min_p, vec2d max_p) {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo - 1) / 2;
+        alive[mid] = hi - lo;
+        if (hi - lo <= leaf_size) return;
+        // split along the wider side of the cell
+        int d = (max_p[0] - min_p[0] >= max_p[1] - min_p[1]) ? 0 : 1;
+        std::nth_element(entries.begin() + lo, entries.begin() + mid, entries.begin() + hi,
+                         [d](auto &a, auto &b) { return a.first[d] < b.first[d]; });
+        split[mid] = d;
+        vec2d left_max = max_p, right_min = min_p;
+        left_max[d] = right_min[d] = entries[mid].first[d];
+        build(entries, lo, mid, min_p, left_max);
+        build(entries, mid + 1, hi, right_min, max_p);
+    }
+
+    int kd_tree_t::nearest(vec2d q) const {
+        std::pair<double, int> best = {std::numeric_limits<double>::infinity(), -1};
+        nearest(0, points.size(), q, {0.0, 0.0}, 0.0, best);
+        return best.second;
+    }
+
+    void kd_tree_t::nearest(int lo, int hi, vec2d q, vec2d offset, double cell_distance2,
+                            std::pair<double, int> &best) const {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo - 1) / 2;
+        if (alive[mid] == 0) return;
+        if (hi - lo <= leaf_size) {
+            for (int i = lo; i < hi; i++) {
+                if (removed[i]) continue;
+                double d2 = distance2(q, points[i]);
+                if (d2 < best.first) best = {d2, index[i]};
+            }
+            return;
+        }
+        if (!removed[mid]) {
+            double d2 = distance2(q, points[mid]);
+            if (d2 < best.first) best = {d2, index[mid]};
+        }
+        // offset holds the distances from q to the cell along every axis, so the far cell is
+        // skipped when even its closest corner is too far
+        int d = split[mid];
+        double diff = q[d] - points[mid][d];
+        double far_distance2 = cell_distance2 - offset[d] * offset[d] + diff * diff;
+        vec2d far_offset = offset;
+        far_offset[d] = diff;
+        if (diff < 0) {
+            nearest(lo, mid, q, offset, cell_distance2, best);
+            if (far_distance2 < best.first) nearest(mid + 1, hi, q, far_offset, far_distance2, best);
+        } else {
+            nearest(mid + 1, hi, q, offset, cell_distance2, best);
+            if (far_distance2 < best.first) nearest(lo, mid, q, far_offset, far_distance2, best);
+        }
+    }
+
+    int kd_tree_t::nearest_to(int city) const {
+        // the cells on the path from the root to the city
+        struct cell_t {
+            int lo, hi;
+            vec2d min_p, max_p;
+        };
+        std::array<cell_t, 64> path;
+        int depth = 0;
+        const int p = position[city];
+        const vec2d q = points[p];
+        for (cell_t c = {0, (int) points.size(), bounds_min, bounds_max};;) {
+            path[depth++] = c;
+            int mid = c.lo + (c.hi - c.lo - 1) / 2;
+            if ((c.hi - c.lo <= leaf_size) || (p == mid)) break;
+            int d = split[mid];
+            if (p < mid) {
+                c.hi = mid;
+                c.max_p[d] = points[mid][d];
+            } else {
+                c.lo = mid + 1;
+                c.min_p[d] = points[mid][d];
+            }
+        }
+        // search the cell of the city and then the siblings going up, until the ball around q
+        // with the best distance lies inside the already searched cell
+        std::pair<double, int> best = {std::numeric_limits<double>::infinity(), -1};
+        auto &leaf = path[depth - 1];
+        nearest(leaf.lo, leaf.hi, q, {0.0, 0.0}, 0.0, best);
+        for (int k = depth - 2; k >= 0; k--) {
+            auto &child = path[k + 1];
+            double r = std::sqrt(best.first);
+            if ((q[0] - child.min_p[0] >= r) && (child.max_p[0] - q[0] >= r) &&
+                (q[1] - child.min_p[1] >= r) && (child.max_p[1] - q[1] >= r))
+                break;
+            auto &cell = path[k];
+            int mid = cell.lo + (cell.hi - cell.lo - 1) / 2;
+            if (!removed[mid]) {
+                double d2 = distance2(q, points[mid]);
+                if (d2 < best.first) best = {d2, index[mid]};
+            }
+            int d = split[mid];
+            vec2d offset = {0.0, 0.0};
+            offset[d] = q[d] - points[mid][d];
+            double cell_distance2 = offset[d] * offset[d];
+            if (cell_distance2 >= best.first) continue;
+            if (child.lo == cell.lo) nearest(mid + 1, cell.hi, q, offset, cell_distance2, best);
+            else nearest(cell.lo, mid, q, offset, cell_distance2, best);
+        }
+        return best.second;
+    }
+
+    std::vector<int> kd_tree_t::k_nearest(vec2d q, int k) const {
+        std::vector<std::pair<double, int>> heap;
+        if (k > 0) k_nearest(0, points.size(), q, k, heap);
+        std::sort_heap(heap.begin(), heap.end());
+        std::vector<int> result(heap.size());
+        std::transform(heap.begin(), heap.end(), result.begin(), [](auto &e) { return e.second; });
+        return result;
+    }
+
+    void kd_tree_t::k_nearest(int lo, int hi, vec2d q, int k, std::vector<std::pair<double, int>> &heap) const {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo - 1) / 2;
+        if (alive[mid] == 0) return;
+        auto consider = [&](int i) {
+            if (removed[i]) return;
+            double d2 = distance2(q, points[i]);
+            if ((int) heap.size() < k) {
+                heap.push_back({d2, index[i]});
+                std::push_heap(heap.begin(), heap.end());
+            } else if (d2 < heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = {d2, index[i]};
+                std::push_heap(heap.begin(), heap.end());
+            }
+        };
+        if (hi - lo <= leaf_size) {
+            for (int i = lo; i < hi; i++) consider(i);
+            return;
+        }
+        consider(mid);
+        double diff = q[split[mid]] - points[mid][split[mid]];
+        int near_lo = lo, near_hi = mid, far_lo = mid + 1, far_hi = hi;
+        if (diff >= 0) {
+            std::swap(near_lo, far_lo);
+            std::swap(near_hi, far_hi);
+        }
+        k_nearest(near_lo, near_hi, q, k, heap);
+        if (((int) heap.size() < k) || (diff * diff < heap.front().first)) k_nearest(far_lo, far_hi, q, k, heap);
+    }
+
+    std::vector<int> kd_tree_t::radius(vec2d q, double r) const {
+        std::vector<int> result;
+        radius(0, points.size(), q, r * r, result);
+        return result;
+    }
+
+    void kd_tree_t::radius(int lo, int hi, vec2d q, double r2, std::vector<int> &result) const {
+        if (lo >= hi) return;
+        int mid = lo + (hi - lo - 1) / 2;
+        if (alive[mid] == 0) return;
+        if (hi - lo <= leaf_size) {
+            for (int i = lo; i < hi; i++)
+                if (!removed[i] && (distance2(q, points[i]) <= r2)) result.push_back(index[i]);
+            return;
+        }
+        if (!removed[mid] && (distance2(q, points[mid]) <= r2)) result.push_back(index[mid]);
+        double diff = q[split[mid]] - points[mid][split[mid]];
+        if ((diff < 0) || (diff * diff <= r2)) radius(lo, mid, q, r2, result);
+        if ((diff >= 0) || (diff * diff <= r2)) radius(mid + 1, hi, q, r2, result);
+    }
+
+    void kd_tree_t::remove(int point) {
+        int p = position[point];
+        if (removed[p]) return;
+        removed[p] = 1;
+        for (int lo = 0, hi = points.size(); lo < hi;) {
+            int mid = lo + (hi - lo - 1) / 2;
+            alive[mid]--;
+            if ((p == mid) || (hi - lo <= leaf_size)) break;
+            if (p < mid) hi = mid;
+            else lo = mid + 1;
+        }
+    }
+
+} // mhe
@@ -0,0 +1,69 @@
+#ifndef MHE_KD_TREE_T_H
+#define MHE_KD_TREE_T_H
+
+#include "vec2d.h"
+
+#include <utility>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Static 2-d tree over the cities that supports removing points.
+     *
+     * The tree is implicit: the points are stored in one array ordered so that the middle element of
+     * every range is the splitting node and the halves are its subtrees. Every node counts the points
+     * still present in its subtree (the small ranges are leaves scanned linearly), so the queries skip
+     * the emptied parts of the plane and the nearest neighbour tour construction stays O(n log n).
+     */
+    class kd_tree_t {
+    public:
+        explicit kd_tree_t(const std::vector<vec2d> &points);
+
+        /// the nearest point that was not removed, -1 if the tree is empty
+        int nearest(vec2d q) const;
+
+        /// the nearest point to the given city (removed or not); the search starts at the cell of the city
+        /// and goes up, so it is much faster than nearest for the points of the tree
+        int nearest_to(int city) const;
+
+        /// at most k nearest points, sorted by the distance
+        std::vector<int> k_nearest(vec2d q, int k) const;
+
+        /// all points within the distance r, in no particular order
+        std::vector<int> radius(vec2d q, double r) const;
+
+        void remove(int point);
+
+        bool contains(int point) const { return !removed[position[point]]; }
+
+        int size() const { return alive.empty() ? 0 : alive[root()]; }
+
+    private:
+        /// ranges that small are not split, the queries scan them
+        static constexpr int leaf_size = 8;
+
+        int root() const { return (points.size() - 1) / 2; }
+
+        void build(std::vector<std::pair<vec2d, int>> &entries, int lo, int hi, vec2d min_p, vec2d max_p);
+
+        void nearest(int lo, int hi, vec2d q, vec2d offset, double cell_distance2,
+                     std::pair<double, int> &best) const;
+
+        void k_nearest(int lo, int hi, vec2d q, int k, std::vector<std::pair<double, int>> &heap) const;
+
+        void radius(int lo, int hi, vec2d q, double r2, std::vector<int> &result) const;
+
+        std::vector<vec2d> points;   ///< points in the tree order
+        std::vector<int> index;      ///< city at the given tree position
+        std::vector<int> position;   ///< tree position of the given city
+        std::vector<char> split;     ///< splitting dimension of the node
+        std::vector<char> removed;
+        std::vector<int> alive;      ///< points present in the subtree of the node
+        vec2d bounds_min;
+        vec2d bounds_max;
+    };
+
+} // mhe
+
+#endif //MHE_KD_TREE_T_H
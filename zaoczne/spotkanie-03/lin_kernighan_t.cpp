@@ -0,0 +1,164 @@
+#include "lin_kernighan_t.h"
+
+namespace mhe {
+
+    namespace {
+        constexpr double epsilon = 1e-10;
+    }
+
+    lin_kernighan_t::lin_kernighan_t(const problem_t &problem_, int k, int max_depth_) :
+            problem(problem_), candidates(problem_, k), max_depth(max_depth_) {
+    }
+
+    void lin_kernighan_t::activate(int city) {
+        if (queued[city]) return;
+        queued[city] = 1;
+        queue.push_back(city);
+    }
+
+    template<class tour_t>
+    void lin_kernighan_t::move(tour_t &tour, int a, int b, int c) {
+        if (tour.next(a) == b) tour.reverse(b, c);
+        else tour.reverse(c, b);
+    }
+
+    template<class tour_t>
+    double lin_kernighan_t::improve(tour_t &tour) {
+        queued.assign(tour.size(), 0);
+        used.assign(tour.size(), 0);
+        stamp = 0;
+        double gain = 0.0;
+        if (tour.size() < 8) return gain;
+        for (double pass_start = -1.0; gain > pass_start;) {
+            pass_start = gain;
+            queue.clear();
+            queue_head = 0;
+            for (int c: tour.cities()) activate(c);
+            while (queue_head < queue.size()) {
+                int t1 = queue[queue_head++];
+                if (queue_head > 4096 && 2 * queue_head > queue.size()) {
+                    queue.erase(queue.begin(), queue.begin() + queue_head);
+                    queue_head = 0;
+                }
+                queued[t1] = 0;
+                double g = chain(tour, t1, tour.next(t1));
+                if (g <= 0) g = chain(tour, t1, tour.prev(t1));
+                if (g <= 0) g = or_opt(tour, t1);
+                if (g > 0) {
+                    gain += g;
+                    activate(t1);
+                }
+            }
+        }
+        return gain;
+    }
+
+    solution_t lin_kernighan_t::improve(solution_t solution) {
+        auto optimize = [&](auto tour) {
+            improve(tour);
+            auto cities = tour.cities();
+            std::copy(cities.begin(), cities.end(), solution.begin());
+        };
+        if (solution.size() >= two_level_tour_t::preferred_size) optimize(two_level_tour_t(solution));
+        else optimize(array_tour_t(solution));
+        return solution;
+    }
+
+    template<class tour_t>
+    double lin_kernighan_t::chain(tour_t &tour, int t1, int t2) {
+        stamp++;
+        used[t1] = used[t2] = stamp;
+        steps.clear();
+        double g = problem.distance(t1, t2); // gain of the open chain
+        double best_gain = 0.0;
+        std::size_t best_depth = 0;
+        while ((int) steps.size() < max_depth) {
+            bool forward = tour.next(t1) == t2;
+            int best_t3 = -1, best_t4 = -1;
+            double best_g = 0.0;
+            auto neighbours = candidates[t2];
+            auto neighbour_distances = candidates.distances(t2);
+            for (std::size_t i = 0; i < neighbours.size(); i++) {
+                double g1 = g - neighbour_distances[i];
+                if (g1 <= epsilon) break;
+                int t3 = neighbours[i];
+                int t4 = forward ? tour.prev(t3) : tour.next(t3);
+                if ((used[t3] == stamp) || (used[t4] == stamp)) continue;
+                // prefer the step that breaks the longest edge
+                double g2 = g1 + problem.distance(t3, t4);
+                if ((best_t3 < 0) || (g2 > best_g)) {
+                    best_t3 = t3;
+                    best_t4 = t4;
+                    best_g = g2;
+                }
+            }
+            if (best_t3 < 0) break;
+            move(tour, t1, t2, best_t4);
+            steps.push_back({t2, best_t3, best_t4});
+            used[best_t3] = used[best_t4] = stamp;
+            g = best_g;
+            double closed = g - problem.distance(best_t4, t1);
+            if (closed > best_gain + epsilon) {
+                best_gain = closed;
+                best_depth = steps.size();
+            }
+            t2 = best_t4;
+        }
+        while (steps.size() > best_depth) {
+            auto [s2, s3, s4] = steps.back();
+            move(tour, t1, s4, s2);
+            steps.pop_back();
+        }
+        for (auto [s2, s3, s4]: steps) {
+            activate(s2);
+            activate(s3);
+            activate(s4);
+        }
+        return best_gain;
+    }
+
+    template<class tour_t>
+    double lin_kernighan_t::or_opt(tour_t &tour, int s1) {
+        const int n = tour.size();
+        int s2 = s1;
+        for (int length = 1; length <= 3; length++, s2 = tour.next(s2)) {
+            if (length + 3 > n) break;
+            int p = tour.prev(s1), nx = tour.next(s2);
+            double removed = problem.distance(p, s1) + problem.distance(s2, nx);
+            double g1 = removed - problem.distance(p, nx);
+            if (g1 <= epsilon) continue;
+            for (int end: {s1, s2}) {
+                auto neighbours = candidates[end];
+                auto neighbour_distances = candidates.distances(end);
+                for (std::size_t i = 0; i < neighbours.size(); i++) {
+                    if (neighbour_distances[i] >= g1) break;
+                    int c = neighbours[i];
+                    if (tour.between(s1, c, s2)) continue;
+                    // the segment goes between c and its successor or its predecessor
+                    for (int d: {tour.next(c), tour.prev(c)}) {
+                        if (tour.between(s1, d, s2)) continue;
+                        int x = c, y = d;
+                        if (d == tour.prev(c)) std::swap(x, y); // now y follows x
+                        if ((x == nx) || (y == p)) continue;
+                        double kept = problem.distance(x, s1) + problem.distance(s2, y);
+                        double reversed = problem.distance(x, s2) + problem.distance(s1, y);
+                        double delta = g1 + problem.distance(x, y) - std::min(kept, reversed);
+                        if (delta <= epsilon) continue;
+                        // p s1..s2 nx .. x y  ->  p nx .. x s2..s1 y  (->  p nx .. x s1..s2 y)
+                        move(tour, p, s1, x);
+                        move(tour, p, x, nx);
+                        if (kept < reversed) move(tour, x, s2, s1);
+                        for (int e: {p, nx, x, y, s1, s2}) activate(e);
+                        return delta;
+                    }
+                }
+            }
+        }
+        return 0.0;
+    }
+
+    template double lin_kernighan_t::improve<array_tour_t>(array_tour_t &tour);
+
+    template double lin_kernighan_t::improve<two_level_tour_t>(two_level_tour_t &tour);
+
+} // mhe
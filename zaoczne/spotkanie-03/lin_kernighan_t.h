@@ -0,0 +1,65 @@
+#ifndef MHE_LIN_KERNIGHAN_T_H
+#define MHE_LIN_KERNIGHAN_T_H
+
+#include "array_tour_t.h"
+#include "candidate_lists_t.h"
+#include "solution_t.h"
+#include "two_level_tour_t.h"
+
+#include <array>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Variable depth local search in the spirit of Lin-Kernighan.
+     *
+     * From the city t1 the edge (t1, t2) is broken and a chain of 2-opt moves is built: every step
+     * adds the edge (t2, t3) to a candidate t3 and breaks (t3, t4), as long as the partial gain stays
+     * positive. The chain is rolled back to its best closed tour. When no chain improves, or-opt moves
+     * are tried: a segment of 1 to 3 cities starting at t1 is moved (also reversed) between two
+     * neighbouring cities taken from the candidate lists.
+     *
+     * Every step modifies only the touched edges of the tour, the length is never recomputed.
+     */
+    class lin_kernighan_t {
+    public:
+        explicit lin_kernighan_t(const problem_t &problem, int k = 8, int max_depth = 50);
+
+        /// improves the tour until no improving move is found, returns the decrease of the tour length;
+        /// available for array_tour_t and two_level_tour_t
+        template<class tour_t>
+        double improve(tour_t &tour);
+
+        /// works on two_level_tour_t for large instances and on array_tour_t otherwise
+        solution_t improve(solution_t solution);
+
+    private:
+        /// replaces edges (a, b), (c, d) with (a, c), (b, d), where d is the neighbour of c on the side away from b;
+        /// only the path b..c is reversed, so d does not have to be passed
+        template<class tour_t>
+        void move(tour_t &tour, int a, int b, int c);
+
+        template<class tour_t>
+        double chain(tour_t &tour, int t1, int t2);
+
+        template<class tour_t>
+        double or_opt(tour_t &tour, int s1);
+
+        void activate(int city);
+
+        const problem_t &problem;
+        candidate_lists_t candidates;
+        int max_depth;
+        std::vector<int> queue;
+        std::vector<char> queued;
+        std::size_t queue_head = 0;
+        /// the chain uses every city at most once, the stamp tells in which chain it was used
+        std::vector<int> used;
+        int stamp = 0;
+        std::vector<std::array<int, 3>> steps;
+    };
+
+} // mhe
+
+#endif //MHE_LIN_KERNIGHAN_T_H
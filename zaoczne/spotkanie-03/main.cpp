@@ -1,20 +1,41 @@
 #include "tp_args.hpp"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
 #include <numeric>
 #include <random>
 #include <set>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "candidate_lists_t.h"
+#include "crossover_t.h"
+#include "eax_t.h"
+#include "kd_tree_t.h"
 #include "solution_t.h"
+#include "two_opt_t.h"
+#include "fitness_cache_t.h"
+#include "lin_kernighan_t.h"
+#include "population_t.h"
+#include "static_ga_t.h"
+#include "steady_state_ga_t.h"
+#include "tsp_ga_config_t.h"
+#include "thread_pool_t.h"
 #include <tuple>
+#include <unordered_set>
 //std::random_device rd;
 
 std::mt19937 rgen(109908093657865);
@@ -43,11 +64,14 @@ solution_t brute_force(solution_t start_point)
 
 solution_t random_hillclimb(solution_t solution)
 {
+    double goal = solution.goal();
     for (int i = 0; i < 5040; i++) {
-        auto new_solution = solution.random_modify(rgen);
-        if (new_solution.goal() <= solution.goal()) {
-            solution = new_solution;
-            std::cout << i << " " << solution << "  " << solution.goal() << std::endl;
+        auto move = solution.random_move(rgen);
+        double delta = solution.delta(move);
+        if (delta <= 0) {
+            solution.apply(move);
+            goal += delta;
+            std::cout << i << " " << solution << "  " << goal << std::endl;
         }
     }
     return solution;
@@ -55,11 +79,14 @@ solution_t random_hillclimb(solution_t solution)
 
 solution_t deterministic_hillclimb(solution_t solution)
 {
+    double goal = solution.goal();
     for (int i = 0; i < 5040; i++) {
-        auto new_solution = solution.best_neighbour();
-        if (new_solution.goal() <= solution.goal()) {
-            solution = new_solution;
-            std::cout << i << " " << solution << "  " << solution.goal() << std::endl;
+        auto move = solution.best_move();
+        double delta = solution.delta(move);
+        if (delta <= 0) {
+            solution.apply(move);
+            goal += delta;
+            std::cout << i << " " << solution << "  " << goal << std::endl;
         }
     }
     return solution;
@@ -67,34 +94,42 @@ solution_t deterministic_hillclimb(solution_t solution)
 
 solution_t tabu_search(solution_t solution)
 {
-    std::list<solution_t> tabu_list;
-    std::set<solution_t> tabu_set;
-
-    tabu_list.push_back(solution);
-    tabu_set.insert(solution);
+    // the tabu set keeps hashes of visited solutions, so the neighbours are never built
+    std::unordered_set<std::uint64_t> tabu_set;
+    auto current = solution;
+    auto current_hash = current.hash();
+    double current_goal = current.goal();
+    tabu_set.insert(current_hash);
 
     solution_t best_globally = solution;
+    double best_goal = current_goal;
     for (int i = 0; i < 5040; i++) {
-        auto neighbours = tabu_list.back().generate_neighbours();
-
-        neighbours.erase(std::remove_if(neighbours.begin(),
-                             neighbours.end(),
-                             [&](solution_t x) { return tabu_set.contains(x); }),
-            neighbours.end());
-        if (neighbours.size() == 0) {
+        bool found = false;
+        move_t next_move{};
+        double next_delta = 0.0;
+        for (auto& move : current.neighbour_moves()) {
+            if (tabu_set.contains(current.hash_after(move, current_hash))) continue;
+            double delta = current.delta(move);
+            if (!found || (delta < next_delta)) {
+                found = true;
+                next_move = move;
+                next_delta = delta;
+            }
+        }
+        if (!found) {
             std::cout << "Ate my tail..." << std::endl;
             return best_globally;
         }
-        auto next_solution = *std::max_element(neighbours.begin(), neighbours.end(), [](auto l, auto r) {
-            return l.goal() > r.goal();
-        });
-
-        if (next_solution.goal() <= best_globally.goal()) {
-            best_globally = next_solution;
-            std::cout << i << " " << best_globally << "  " << best_globally.goal() << std::endl;
+        current_hash = current.hash_after(next_move, current_hash);
+        current.apply(next_move);
+        current_goal += next_delta;
+
+        if (current_goal <= best_goal) {
+            best_globally = current;
+            best_goal = current_goal;
+            std::cout << i << " " << best_globally << "  " << best_goal << std::endl;
         }
-        tabu_list.push_back(next_solution);
-        tabu_set.insert(next_solution);
+        tabu_set.insert(current_hash);
     }
     return best_globally;
 }
@@ -103,20 +138,26 @@ solution_t sim_annealing(const solution_t solution, std::function<double(int)> T
 {
     auto best_solution = solution; ///< globally best
     auto s = solution;             ///< current solution
+    double best_goal = best_solution.goal();
+    double goal = best_goal;
 
     for (int i = 1; i < 5040; i++) {
-        auto new_solution = s.random_modify(rgen);
-        if (new_solution.goal() <= s.goal()) {
-            s = new_solution;
-            if (new_solution.goal() <= best_solution.goal()) {
+        auto move = s.random_move(rgen);
+        double delta = s.delta(move);
+        if (delta <= 0) {
+            s.apply(move);
+            goal += delta;
+            if (goal <= best_goal) {
                 best_solution = s;
+                best_goal = goal;
                 std::cout << "*";
             }
-            std::cout << i << " " << s << "  " << s.goal() << std::endl;
+            std::cout << i << " " << s << "  " << goal << std::endl;
         } else {
             std::uniform_real_distribution<double> u(0.0, 1.0);
-            if (u(rgen) < std::exp(-std::abs(new_solution.goal() - s.goal()) / T(i))) {
-                s = new_solution;
+            if (u(rgen) < std::exp(-std::abs(delta) / T(i))) {
+                s.apply(move);
+                goal += delta;
             }
         }
     }
@@ -131,6 +172,13 @@ public:
     virtual bool termination_condition(std::vector<solution_t>, std::vector<double>& fitnesses) = 0;
     virtual std::vector<T> get_initial_population() = 0;
     virtual double fitness(T) = 0;
+    /// fitness of the whole population at once, override it when batches can be evaluated faster
+    virtual void evaluate_all(const std::vector<T>& population, std::vector<double>& fitnesses)
+    {
+        fitnesses.resize(population.size());
+        for (int i = 0; i < population.size(); i++)
+            fitnesses[i] = fitness(population[i]);
+    }
     virtual std::vector<T> selection(std::vector<double>, std::vector<T>, std::mt19937& rgen) = 0;
     virtual std::vector<T> crossover(std::vector<T>, std::mt19937& rgen) = 0;
     virtual std::vector<T> mutation(std::vector<T>, std::mt19937& rgen) = 0;
@@ -146,7 +194,19 @@ public:
 
     double p_crossover;
     double p_mutation;
-    tsp_config_t(int iter, int pop_size, double p_crossover_, double p_mutation_, problem_t problem_, std::mt19937& rgen)
+
+    thread_pool_t pool;
+    /// memo of the fitness values, not used when empty
+    std::unique_ptr<fitness_cache_t> cache;
+    /// individuals per chunk of work; the chunks do not depend on the number of threads, so neither does the result
+    static constexpr int grain = 64;
+    /// fitness carried from the parent to each individual of the population being built, NaN when it must be evaluated
+    std::vector<double> inherited_fitness;
+    /// number of individuals actually evaluated, the rest reused the fitness of their parents; EAX counts it from the pool
+    std::atomic<long long> evaluations = 0;
+
+    tsp_config_t(int iter, int pop_size, double p_crossover_, double p_mutation_, const problem_t& problem_, int threads = 1)
+        : pool(threads)
     {
         max_iterations = iter;
         iteration = 0;
@@ -154,7 +214,22 @@ public:
         problem = problem_;
         p_mutation = p_mutation_;
         p_crossover = p_crossover_;
+        packed = population_t(problem, 0);
+    }
+    /// calls f(i, chunk_rgen) for every i in [0, n) on the pool, every chunk has its own generator;
+    /// seed_seq mixes the draw from rgen with the start of the chunk, so no two chunks share a stream
+    template <class F>
+    void for_each_index(int n, std::mt19937& rgen, F f)
+    {
+        auto seed = rgen();
+        pool.parallel_for(0, n, grain, [&](int first, int last) {
+            std::seed_seq chunk_seed{(std::uint32_t)seed, (std::uint32_t)first};
+            std::mt19937 chunk_rgen(chunk_seed);
+            for (int i = first; i < last; i++)
+                f(i, chunk_rgen);
+        });
     }
+
     virtual bool termination_condition(std::vector<solution_t>, std::vector<double>& fitnesses)
     {
         iteration++;
@@ -173,100 +248,148 @@ public:
 
     virtual double fitness(solution_t solution)
     {
-        return 1.0 / (1 + solution.goal());
+        auto f = [](const solution_t& s) { return 1.0 / (1 + s.goal()); };
+        return cache ? (*cache)(solution, f) : f(solution);
     };
 
-    virtual std::vector<solution_t> selection(std::vector<double> fitnesses, std::vector<solution_t> population, std::mt19937& rgen)
+    /// makes sure there is an inherited fitness slot for each of n individuals, all of them unknown if it was not
+    void expect_inherited(std::size_t n)
     {
-        std::vector<solution_t> ret;
-        while (ret.size() < population.size()) {
-            std::uniform_int_distribution<int> dist(0, population.size() - 1);
-            int a_idx = dist(rgen);
-            int b_idx = dist(rgen);
-            if (fitnesses[a_idx] >= fitnesses[b_idx])
-                ret.push_back(population[a_idx]);
-            else
-                ret.push_back(population[b_idx]);
+        if (inherited_fitness.size() != n)
+            inherited_fitness.assign(n, std::numeric_limits<double>::quiet_NaN());
+    }
+    /// individual i no longer has the fitness of its parent if the operator changed it
+    void invalidate_if_changed(int i, const solution_t& before, const solution_t& after)
+    {
+        if (before != after)
+            inherited_fitness[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    population_t packed;
+    std::vector<int> dirty;
+    std::vector<double> goals;
+    /// evaluates only the individuals without an inherited fitness; the rest keep the fitness of their parents
+    virtual void evaluate_all(const std::vector<solution_t>& population, std::vector<double>& fitnesses)
+    {
+        expect_inherited(population.size());
+        fitnesses = inherited_fitness;
+        inherited_fitness.clear();
+        dirty.clear();
+        for (int i = 0; i < population.size(); i++)
+            if (std::isnan(fitnesses[i])) dirty.push_back(i);
+        evaluations += dirty.size();
+        if (cache) {
+            pool.parallel_for(0, dirty.size(), grain, [&](int first, int last) {
+                for (int k = first; k < last; k++)
+                    fitnesses[dirty[k]] = fitness(population[dirty[k]]);
+            });
+            return;
         }
+        packed.resize(dirty.size());
+        goals.resize(dirty.size());
+        pool.parallel_for(0, dirty.size(), grain, [&](int first, int last) {
+            for (int k = first; k < last; k++)
+                packed.set(k, population[dirty[k]]);
+            mhe::evaluate_all(packed, first, last, goals.data() + first);
+            for (int k = first; k < last; k++)
+                fitnesses[dirty[k]] = 1.0 / (1 + goals[k]);
+        });
+    }
+
+    virtual std::vector<solution_t> selection(std::vector<double> fitnesses, std::vector<solution_t> population, std::mt19937& rgen)
+    {
+        std::vector<solution_t> ret(population.size());
+        inherited_fitness.resize(population.size());
+        for_each_index(population.size(), rgen, [&](int i, std::mt19937& rgen) {
+            int winner = tsp_ga_config_t::tournament(
+                population.size(), [&](int a, int b) { return fitnesses[a] >= fitnesses[b]; }, rgen);
+            ret[i] = population[winner];
+            inherited_fitness[i] = fitnesses[winner];
+        });
         return ret;
     }
 
+    crossover_t::kind_t crossover_kind = crossover_t::kind_t::pmx;
+    /// candidate lists for the sub-tour merging of EAX, the crossover is EAX when they are set
+    std::unique_ptr<candidate_lists_t> eax_candidates;
     std::pair<solution_t, solution_t> crossover(const std::pair<solution_t, solution_t>& solutions, std::mt19937& rd_generator)
     {
-        using namespace std;
-        std::vector<solution_t> offspring = {solutions.first, solutions.second};
-        uniform_int_distribution<int> distr(0, solutions.first.size() - 1);
-        int cuts[2] = {distr(rd_generator), distr(rd_generator)};
-        if (cuts[0] == cuts[1]) return solutions;
-        if (cuts[0] > cuts[1]) swap(cuts[0], cuts[1]);
-
-        map<int, int> taken_cities[2];
-
-        for (int i = cuts[0]; i < cuts[1]; i++) {
-            swap(offspring[0][i], offspring[1][i]);
-            taken_cities[0][offspring[0][i]] = offspring[1][i];
-            taken_cities[1][offspring[1][i]] = offspring[0][i];
-        }
-        for (int v = 0; v < 2; v++)
-            for (int i = 0; i < offspring[0].size(); i++) {
-                if (i == cuts[0]) {
-                    i = cuts[1] - 1;
-                    continue;
-                }
-                while (taken_cities[v].count(offspring[v][i])) {
-                    offspring[v][i] = taken_cities[v].at(offspring[v][i]);
-                }
-            }
-        return {offspring[0], offspring[1]};
+        // every thread of the pool has its own scratch buffers
+        thread_local crossover_t crossover_op(0);
+        if (crossover_op.cities() != (int) problem.size()) crossover_op = crossover_t(problem.size());
+        std::pair<solution_t, solution_t> offspring = solutions;
+        crossover_op(crossover_kind, solutions.first, solutions.second, offspring.first, offspring.second, rd_generator);
+        return offspring;
+    }
+
+    /// children i and i + 1 by EAX, their goals come from the edge deltas, so they never have to be evaluated;
+    /// the parents are, once each, so the rounding of the deltas does not pile up over the generations
+    void eax_pair(const std::vector<solution_t>& pop, std::vector<solution_t>& offspring, int i, std::mt19937& rgen)
+    {
+        thread_local std::unique_ptr<eax_t> eax;
+        if (!eax || (&eax->candidates != eax_candidates.get())) eax = std::make_unique<eax_t>(problem, *eax_candidates);
+        double goal_a = pop[i].goal(), goal_b = pop[i + 1].goal();
+        evaluations += 2;
+        offspring[i] = pop[i];
+        offspring[i + 1] = pop[i + 1];
+        inherited_fitness[i] = 1.0 / (1 + (*eax)(pop[i], goal_a, pop[i + 1], offspring[i], rgen));
+        inherited_fitness[i + 1] = 1.0 / (1 + (*eax)(pop[i + 1], goal_b, pop[i], offspring[i + 1], rgen));
     }
 
     virtual std::vector<solution_t> crossover(std::vector<solution_t> pop, std::mt19937& rgen)
     {
-        std::vector<solution_t> offspring;
-        for (int i = 0; i < pop.size(); i += 2) {
+        std::vector<solution_t> offspring(pop.size());
+        expect_inherited(pop.size());
+        for_each_index(pop.size() / 2, rgen, [&](int pair, std::mt19937& rgen) {
+            int i = pair * 2;
             std::uniform_real_distribution<double> distr(0.0, 1.0);
             if (distr(rgen) > p_mutation) {
-                auto [a, b] = crossover(std::make_pair(pop.at(i), pop.at(i + 1)), rgen);
-                offspring.push_back(a);
-                offspring.push_back(b);
+                if (eax_candidates) {
+                    eax_pair(pop, offspring, i, rgen);
+                } else {
+                    std::tie(offspring[i], offspring[i + 1]) = crossover(std::make_pair(pop.at(i), pop.at(i + 1)), rgen);
+                    invalidate_if_changed(i, pop[i], offspring[i]);
+                    invalidate_if_changed(i + 1, pop[i + 1], offspring[i + 1]);
+                }
             } else {
-                offspring.push_back(pop.at(i));
-                offspring.push_back(pop.at(i + 1));
+                offspring[i] = pop.at(i);
+                offspring[i + 1] = pop.at(i + 1);
             }
-        }
+        });
+        if (pop.size() % 2) offspring.back() = pop.back();
         return offspring;
     };
     virtual std::vector<solution_t> mutation(std::vector<solution_t> sol, std::mt19937& rgen)
     {
         std::vector<solution_t> ret(sol.size());
-        std::transform(sol.begin(), sol.end(), ret.begin(), [&](auto e) {
+        expect_inherited(sol.size());
+        for_each_index(sol.size(), rgen, [&](int i, std::mt19937& rgen) {
             std::uniform_real_distribution<double> distr(0.0, 1.0);
-            if (distr(rgen) > p_mutation)
-                return e.random_modify(rgen);
-            else
-                return e;
+            if (distr(rgen) > p_mutation) {
+                ret[i] = sol[i];
+                tsp_ga_config_t::swap_neighbours(ret[i], rgen);
+                invalidate_if_changed(i, sol[i], ret[i]);
+            } else {
+                ret[i] = sol[i];
+            }
         });
         return ret;
     };
 };
 
-
 template <class T>
 solution_t generic_algorithm(genetic_algorithm_config_t<T>& cfg, int conv_curve, std::mt19937& rgen)
 {
     auto population = cfg.get_initial_population();
     std::vector<double> fitnesses;
     int iteration = 0;
-    for (int i = 0; i < population.size(); i++)
-        fitnesses.push_back(cfg.fitness(population[i]));
+    cfg.evaluate_all(population, fitnesses);
     while (cfg.termination_condition(population, fitnesses)) {
         auto parents = cfg.selection(fitnesses, population, rgen);
         auto offspring = cfg.crossover(parents, rgen);
         offspring = cfg.mutation(offspring, rgen);
         population = offspring;
-        fitnesses.clear();
-        for (int i = 0; i < population.size(); i++)
-            fitnesses.push_back(cfg.fitness(population[i]));
+        cfg.evaluate_all(population, fitnesses);
         if (conv_curve > 0) {
             if ((iteration % conv_curve) == 0) {
                 double average = std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0) / fitnesses.size();
@@ -275,7 +398,8 @@ solution_t generic_algorithm(genetic_algorithm_config_t<T>& cfg, int conv_curve,
         }
         iteration++;
     }
-    return *std::max_element(population.begin(), population.end(), [&](T l, T r) { return cfg.fitness(l) > cfg.fitness(r); });
+    // fitnesses belong to the last population, so the winner needs no more evaluations
+    return population[std::max_element(fitnesses.begin(), fitnesses.end()) - fitnesses.begin()];
 }
 
 
@@ -283,15 +407,11 @@ solution_t shortest_distance(solution_t solution)
 {
     solution_t result = solution;
     auto& problem = *solution.problem;
-    solution.erase(solution.begin());
+    kd_tree_t unvisited(problem);
+    unvisited.remove(result[0]);
     for (int i = 1; i < result.size(); i++) {
-        auto found = std::min_element(solution.begin(), solution.end(), [&](auto a, auto b) {
-            double dist_a = len(problem[result[i - 1]] - problem[a]);
-            double dist_b = len(problem[result[i - 1]] - problem[b]);
-            return dist_a < dist_b;
-        });
-        result[i] = *found;
-        solution.erase(found);
+        result[i] = unvisited.nearest_to(result[i - 1]);
+        unvisited.remove(result[i]);
     }
     return result;
 }
@@ -337,18 +457,32 @@ int main(int argc, char** argv)
     auto count_time = arg(argc, argv, "count_time", false, "print time");
 
     auto problem_size = arg(argc, argv, "problem_size", 30, "the number of cities");
+    auto area = arg(argc, argv, "area", 10.0, "width and height of the area with the cities (use a big one for int32 distances)");
     auto iterations = arg(argc, argv, "iterations", 1000, "iterations count");
     auto pop_size = arg(argc, argv, "pop_size", 5000, "population size");
     auto p_crossover = arg(argc, argv, "p_crossover", 0.1, "crossover probability");
     auto p_mutation = arg(argc, argv, "p_mutation", 0.1, "mutation probability");
+    auto candidates = arg(argc, argv, "candidates", 8, "the length of candidate lists for two_opt, lin_kernighan and eax");
+    auto fitness_cache = arg(argc, argv, "fitness_cache", 0, "capacity of the ga fitness cache, 0 disables it");
+    auto cache_stats = arg(argc, argv, "cache_stats", false, "print hits and misses of the fitness cache");
+    auto eval_stats = arg(argc, argv, "eval_stats", false, "print how many individuals the ga has evaluated");
+    auto crossover = arg(argc, argv, "crossover", std::string("pmx"), "crossover for ga, static_ga, generational_ga and steady_state_ga: pmx, ox, cx or erx, and eax for ga only");
+    auto replacement = arg(argc, argv, "replacement", std::string("worst"), "who the children of steady_state_ga replace: worst or tournament");
+    auto threads = arg(argc, argv, "threads", (int)std::max(1u, std::thread::hardware_concurrency()), "number of threads for the ga");
+
+    std::map<std::string, std::function<solution_t(solution_t)>> methods;
+    std::string methods_list = "Available methods:";
+    for (auto name : {"ga", "static_ga", "generational_ga", "steady_state_ga", "two_opt", "lin_kernighan", "shortest_distance", "random_hillclimb", "deterministic_hillclimb", "tabu_search", "sim_annealing", "brute_force"})
+        methods_list += std::string(" ") + name;
+    auto method = arg(argc, argv, "method", std::string("ga"), methods_list);
     if (help) {
         std::cout << "help screen.." << std::endl;
         args_info(std::cout);
         return 0;
     }
 
-    problem_t tsp_problem = generate_problem(problem_size, 10,
-        10, rgen); //{{1.3, 1}, {2.4, 1}, {1.5, 2}, {3.1, 1}, {3.2, 7}, {3.3, 9}, {1.4, 4}};
+    problem_t tsp_problem = generate_problem(problem_size, area,
+        area, rgen); //{{1.3, 1}, {2.4, 1}, {1.5, 2}, {3.1, 1}, {3.2, 7}, {3.3, 9}, {1.4, 4}};
     
     std::random_device rd;
     rgen.seed(rd());
@@ -361,9 +495,43 @@ int main(int argc, char** argv)
     //solution = deterministic_hillclimb(solution);
     //solution = tabu_search(solution);
     //solution = sim_annealing(solution, [](int k){return 1000.0/k;});
-    tsp_config_t config(iterations, pop_size, p_mutation, p_crossover, tsp_problem, rgen);
+    tsp_config_t config(iterations, pop_size, p_mutation, p_crossover, tsp_problem, threads);
+    if (crossover == "eax")
+        config.eax_candidates = std::make_unique<candidate_lists_t>(tsp_problem, candidates);
+    else
+        config.crossover_kind = crossover_t::kind_of(crossover);
+    if (fitness_cache > 0) config.cache = std::make_unique<fitness_cache_t>(fitness_cache);
+    methods["ga"] = [&](solution_t) { return generic_algorithm<solution_t>(config, conv_curve, rgen); };
+    // the generational loop of ga, but with the operators bound at compile time
+    auto run_static_ga = [&](solution_t s, double p_crossover_, double p_mutation_) {
+        if (config.eax_candidates) throw std::invalid_argument("eax works only with the ga method");
+        tsp_ga_config_t ga_config(*s.problem, pop_size, iterations, p_crossover_, p_mutation_);
+        ga_config.crossover_kind = config.crossover_kind;
+        static_ga_t<tsp_ga_config_t> ga(*s.problem, ga_config);
+        ga.conv_curve = conv_curve;
+        return ga.run(rgen);
+    };
+    // tsp_config_t gates both of its operators with its p_mutation, static_ga searches the same way
+    methods["static_ga"] = [&](solution_t s) { return run_static_ga(s, config.p_mutation, config.p_mutation); };
+    methods["generational_ga"] = [&](solution_t s) { return run_static_ga(s, p_crossover, p_mutation); };
+    methods["steady_state_ga"] = [&](solution_t s) {
+        if (config.eax_candidates) throw std::invalid_argument("eax works only with the ga method");
+        steady_state_ga_t ga(*s.problem, pop_size, p_crossover, p_mutation,
+            (replacement == "tournament") ? steady_state_ga_t::replacement_t::tournament : steady_state_ga_t::replacement_t::worst);
+        ga.crossover_kind = config.crossover_kind;
+        ga.conv_curve = conv_curve;
+        return ga.run(iterations, rgen);
+    };
+    methods["two_opt"] = [&](solution_t s) { return two_opt_t(*s.problem, candidates).improve(shortest_distance(s)); };
+    methods["lin_kernighan"] = [&](solution_t s) { return lin_kernighan_t(*s.problem, candidates).improve(shortest_distance(s)); };
+    methods["shortest_distance"] = shortest_distance;
+    methods["random_hillclimb"] = random_hillclimb;
+    methods["deterministic_hillclimb"] = deterministic_hillclimb;
+    methods["tabu_search"] = tabu_search;
+    methods["sim_annealing"] = [](solution_t s) { return sim_annealing(s, [](int k) { return 1000.0 / k; }); };
+    methods["brute_force"] = brute_force;
     auto start = std::chrono::steady_clock::now();
-    solution = generic_algorithm<solution_t>(config, conv_curve, rgen);
+    solution = methods.at(method)(solution);
     auto end = std::chrono::steady_clock::now();
     if (count_time) std::cout << (end - start).count() << " ";
 
@@ -373,5 +541,11 @@ int main(int argc, char** argv)
     if (result_fit) {
         std::cout << solution.goal() << std::endl;
     }
+    if (cache_stats && config.cache) {
+        std::cout << "fitness cache hits " << config.cache->hits() << " misses " << config.cache->misses() << std::endl;
+    }
+    if (eval_stats) {
+        std::cout << "fitness evaluations " << config.evaluations << std::endl;
+    }
     return 0;
 }
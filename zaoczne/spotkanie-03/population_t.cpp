@@ -0,0 +1,74 @@
+#include "population_t.h"
+
+#include <algorithm>
+
+namespace mhe {
+
+    population_t::population_t(const problem_t &problem_, int count_) :
+            problem(&problem_), n(problem_.size()) {
+        resize(count_);
+    }
+
+    void population_t::resize(int count_) {
+        count = count_;
+        genes.resize(std::size_t(count) * n);
+    }
+
+    solution_t population_t::at(int i) const {
+        solution_t solution;
+        auto row = (*this)[i];
+        solution.assign(row.begin(), row.end());
+        solution.problem = problem;
+        return solution;
+    }
+
+    void population_t::set(int i, const std::vector<int> &chromosome) {
+        std::copy(chromosome.begin(), chromosome.end(), (*this)[i].begin());
+    }
+
+    namespace {
+        /// every lane sums its edges in the same order as solution_t::goal
+        template<int lanes, class distance_f>
+        void tour_lengths(const population_t &population, int first, distance_f distance, double *out) {
+            const int n = population.cities();
+            const int *row[lanes];
+            double sum[lanes] = {};
+            for (int k = 0; k < lanes; k++) row[k] = population[first + k].data();
+            for (int i = 1; i < n; i++)
+                for (int k = 0; k < lanes; k++)
+                    sum[k] += distance(row[k][i - 1], row[k][i]);
+            for (int k = 0; k < lanes; k++)
+                out[k] = sum[k] + distance(row[k][n - 1], row[k][0]);
+        }
+
+        template<class distance_f>
+        void evaluate_all(const population_t &population, int first, int last, distance_f distance, double *out) {
+            constexpr int lanes = 8;
+            int t = first;
+            for (; t + lanes <= last; t += lanes)
+                tour_lengths<lanes>(population, t, distance, out + (t - first));
+            for (; t < last; t++)
+                tour_lengths<1>(population, t, distance, out + (t - first));
+        }
+    }
+
+    void evaluate_all(const population_t &population, std::vector<double> &out_goals) {
+        out_goals.assign(population.size(), 0.0);
+        evaluate_all(population, 0, population.size(), out_goals.data());
+    }
+
+    void evaluate_all(const population_t &population, int first, int last, double *out_goals) {
+        if (population.cities() == 0) {
+            std::fill(out_goals, out_goals + (last - first), 0.0);
+            return;
+        }
+        auto &p = *population.problem;
+        if (p.distances) {
+            auto &d = *p.distances;
+            evaluate_all(population, first, last, [&d](int a, int b) { return d(a, b); }, out_goals);
+        } else {
+            evaluate_all(population, first, last, [&p](int a, int b) { return p.distance(a, b); }, out_goals);
+        }
+    }
+
+} // mhe
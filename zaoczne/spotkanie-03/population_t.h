@@ -0,0 +1,62 @@
+#ifndef MHE_POPULATION_T_H
+#define MHE_POPULATION_T_H
+
+#include "problem_t.h"
+#include "solution_t.h"
+
+#include <span>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Chromosomes of the whole population in one contiguous row-major matrix of city indices.
+     *
+     * Row i is the tour of individual i. The rows share one problem, so an individual costs
+     * only cities() ints and the whole population is a single allocation.
+     */
+    class population_t {
+    public:
+        const problem_t *problem = nullptr;
+
+        population_t() = default;
+        population_t(const problem_t &problem_, int count_);
+
+        int size() const { return count; }
+
+        int cities() const { return n; }
+
+        void resize(int count_);
+
+        std::span<int> operator[](int i) {
+            return {genes.data() + std::size_t(i) * n, std::size_t(n)};
+        }
+
+        std::span<const int> operator[](int i) const {
+            return {genes.data() + std::size_t(i) * n, std::size_t(n)};
+        }
+
+        /// copy of the row i as a standalone solution
+        solution_t at(int i) const;
+        void set(int i, const std::vector<int> &chromosome);
+
+    private:
+        int n = 0;
+        int count = 0;
+        std::vector<int> genes;
+    };
+
+    /**
+     * Goal of every individual, the same values as solution_t::goal gives.
+     *
+     * The tours are walked in lockstep, several at a time, so the independent distance
+     * lookups overlap instead of waiting for each other.
+     */
+    void evaluate_all(const population_t &population, std::vector<double> &out_goals);
+
+    /// goals of the individuals [first, last) written to out_goals[0, last - first), for splitting the work
+    void evaluate_all(const population_t &population, int first, int last, double *out_goals);
+
+} // mhe
+
+#endif //MHE_POPULATION_T_H
@@ -0,0 +1,50 @@
+#ifndef MHE_PRECISION_T_H
+#define MHE_PRECISION_T_H
+
+#include <cmath>
+#include <cstdint>
+
+namespace mhe {
+
+    /**
+     * Precision policies of the distances between cities.
+     *
+     * value_t is what the distance table stores for one edge and of turns the euclidean
+     * length into it. The policy of the program is chosen at compile time with
+     * MHE_DISTANCE_PRECISION (double, float or int32).
+     */
+    struct double_precision_t {
+        using value_t = double;
+
+        static value_t of(double length) { return length; }
+    };
+
+    /// half of the memory of double, about 7 significant digits
+    struct float_precision_t {
+        using value_t = float;
+
+        static value_t of(double length) { return static_cast<float>(length); }
+    };
+
+    /**
+     * The length rounded to the nearest integer, like EUC_2D in TSPLIB. The sums of such
+     * distances are exact, so comparisons of tours give the same answers on every build.
+     * The coordinates should be scaled so that the rounding does not matter much.
+     */
+    struct int32_precision_t {
+        using value_t = std::int32_t;
+
+        static value_t of(double length) { return static_cast<std::int32_t>(std::lround(length)); }
+    };
+
+#if defined(MHE_DISTANCE_PRECISION_FLOAT)
+    using distance_precision_t = float_precision_t;
+#elif defined(MHE_DISTANCE_PRECISION_INT32)
+    using distance_precision_t = int32_precision_t;
+#else
+    using distance_precision_t = double_precision_t;
+#endif
+
+} // mhe
+
+#endif //MHE_PRECISION_T_H
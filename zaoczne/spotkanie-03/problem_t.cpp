@@ -12,6 +12,10 @@
 
 namespace mhe {
 
+    void problem_t::build_distances() {
+        distances = distance_matrix_t<>::build(*this);
+    }
+
     problem_t generate_problem(int size, double w, double h, std::mt19937 &rgen) {
         std::uniform_real_distribution<double> w_distr(0.0, w);
         std::uniform_real_distribution<double> h_distr(0.0, h);
@@ -19,6 +23,7 @@ namespace mhe {
         for (int i = 0; i < size; i++) {
             problem.push_back({w_distr(rgen), h_distr(rgen)});
         }
+        problem.build_distances();
         return problem;
     }
 
@@ -5,13 +5,35 @@
 #ifndef MHE_PROBLEM_T_H
 #define MHE_PROBLEM_T_H
 
+#include "distance_matrix_t.h"
 #include "vec2d.h"
 
 #include <vector>
 #include <iostream>
+#include <memory>
 #include <random>
 namespace mhe {
-    using problem_t = std::vector<vec2d>;
+    /**
+     * The cities of the TSP instance together with the (optional) table of distances.
+     *
+     * The distance table is shared between copies of the problem, so it is built only once
+     * by build_distances. Without it the distances are computed on the fly, rounded the
+     * same way as the table would round them.
+     */
+    class problem_t : public std::vector<vec2d> {
+    public:
+        using std::vector<vec2d>::vector;
+
+        std::shared_ptr<const distance_matrix_t<>> distances;
+
+        void build_distances();
+
+        /// distance in the precision chosen by distance_precision_t, with or without the table
+        double distance(int a, int b) const {
+            if (distances) return (*distances)(a, b);
+            return distance_precision_t::of(len((*this)[a] - (*this)[b]));
+        }
+    };
 
     problem_t generate_problem(int size, double w, double h, std::mt19937 &rgen);
 
@@ -6,37 +6,45 @@
 
 namespace mhe {
 
-    solution_t solution_t::for_problem(std::shared_ptr<problem_t> problem_) {
+    solution_t solution_t::for_problem(const problem_t &problem_) {
         solution_t sol;
-        sol.resize(problem_->size());
+        sol.resize(problem_.size());
         std::generate(sol.begin(), sol.end(), [n = 0]() mutable { return n++; });
-        sol.problem = problem_;
+        sol.problem = &problem_;
         return sol;
     }
 
-    solution_t solution_t::random_solution(problem_t tsp_problem, std::mt19937 &rgen) {
+    solution_t solution_t::random_solution(const problem_t &tsp_problem, std::mt19937 &rgen) {
 
-        auto solution = solution_t::for_problem(make_shared<problem_t>(tsp_problem));
+        auto solution = solution_t::for_problem(tsp_problem);
         std::shuffle(solution.begin(), solution.end(), rgen);
         return solution;
     }
 
     double solution_t::goal() const {
+        auto &t = *this;
+        if (t.empty()) return 0.0;
+        const int n = size();
         double sum_distance = 0;
-        for (int i = 0; i < size(); i++) {
-            auto &p = *problem;
-            auto &t = *this;
-            sum_distance += len(p[t[i]] - p[t[(i + 1) % size()]]);
+        if (problem->distances) {
+            auto &d = *problem->distances;
+            for (int i = 1; i < n; i++)
+                sum_distance += d(t[i - 1], t[i]);
+            return sum_distance + d(t.back(), t.front());
         }
-        return sum_distance;
+        auto &p = *problem;
+        for (int i = 1; i < n; i++)
+            sum_distance += p.distance(t[i - 1], t[i]);
+        return sum_distance + p.distance(t.back(), t.front());
     }
 
     solution_t solution_t::start_from_zero() const {
         solution_t ret = *this;
-        for (int i = 1; i < size(); i++) {
+        const int n = size();
+        for (int i = 1; i < n; i++) {
             if (at(i) == 0) {
-                for (int j = 0; j < size(); j++) {
-                    ret[j] = at((i + j) % size());
+                for (int j = 0; j < n; j++) {
+                    ret[j] = at((i + j) % n);
                 }
                 break;
             }
@@ -45,20 +53,16 @@ namespace mhe {
     }
 
     solution_t solution_t::random_modify(std::mt19937 &rgen) const {
-        using namespace std;
         solution_t current_point = *this;
-        uniform_int_distribution<int> distr(0, size() - 1);
-        int a = distr(rgen);
-        std::swap(current_point[a], current_point[(a + 1) % current_point.size()]);
+        current_point.apply(random_move(rgen));
         return current_point;
     }
 
     std::vector<solution_t> solution_t::generate_neighbours() const {
-        auto current_point = *this;
         std::vector<solution_t> result;
-        for (int i = 0; i < current_point.size(); i++) {
-            solution_t neighbour = current_point;
-            std::swap(neighbour[i], neighbour[(i + 1) % current_point.size()]);
+        for (auto &m: neighbour_moves()) {
+            solution_t neighbour = *this;
+            neighbour.apply(m);
             result.push_back(neighbour);
         }
         return result;
@@ -66,14 +70,92 @@ namespace mhe {
 
 
     solution_t solution_t::best_neighbour() const {
-        auto current_point = *this;
-        using namespace std;
-        std::vector<solution_t> neighbours = current_point.generate_neighbours();
-        return *std::max_element(neighbours.begin(), neighbours.end(), [](auto l, auto r) {
-            return l.goal() > r.goal();
+        solution_t neighbour = *this;
+        neighbour.apply(best_move());
+        return neighbour;
+    }
+
+    double solution_t::delta(const move_t &m) const {
+        const int n = size();
+        auto &t = *this;
+        auto &p = *problem;
+        if (m.kind == move_t::kind_t::reverse) {
+            if ((m.i == m.j) || (m.j - m.i + 1 >= n - 1)) return 0.0;
+            int a = t[(m.i + n - 1) % n], b = t[m.i], c = t[m.j], d = t[(m.j + 1) % n];
+            return p.distance(a, c) + p.distance(b, d) - p.distance(a, b) - p.distance(c, d);
+        }
+        if (m.i == m.j) return 0.0;
+        // edge k connects positions k and k+1, the swap touches at most 4 of them
+        int edges[4] = {(m.i + n - 1) % n, m.i, (m.j + n - 1) % n, m.j};
+        auto city_after = [&](int k) {
+            k %= n;
+            if (k == m.i) return t[m.j];
+            if (k == m.j) return t[m.i];
+            return t[k];
+        };
+        double result = 0.0;
+        for (int e = 0; e < 4; e++) {
+            if (std::find(edges, edges + e, edges[e]) != edges + e) continue;
+            int k = edges[e];
+            result += p.distance(city_after(k), city_after(k + 1)) - p.distance(t[k], t[(k + 1) % n]);
+        }
+        return result;
+    }
+
+    void solution_t::apply(const move_t &m) {
+        if (m.kind == move_t::kind_t::reverse)
+            std::reverse(begin() + m.i, begin() + m.j + 1);
+        else
+            std::swap(at(m.i), at(m.j));
+    }
+
+    move_t solution_t::random_move(std::mt19937 &rgen) const {
+        std::uniform_int_distribution<int> distr(0, size() - 1);
+        int a = distr(rgen);
+        return {move_t::kind_t::swap, a, (a + 1) % (int) size()};
+    }
+
+    std::vector<move_t> solution_t::neighbour_moves() const {
+        std::vector<move_t> result;
+        const int n = size();
+        for (int i = 0; i < n; i++)
+            result.push_back({move_t::kind_t::swap, i, (i + 1) % n});
+        return result;
+    }
+
+    move_t solution_t::best_move() const {
+        auto moves = neighbour_moves();
+        return *std::min_element(moves.begin(), moves.end(), [this](auto &l, auto &r) {
+            return delta(l) < delta(r);
         });
     }
 
+    /// splitmix64 finalizer over (position, city)
+    static std::uint64_t position_hash(std::uint64_t position, std::uint64_t city) {
+        std::uint64_t z = (position << 32 | city) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    std::uint64_t solution_t::hash() const {
+        std::uint64_t h = 0;
+        const int n = size();
+        for (int i = 0; i < n; i++) h ^= position_hash(i, at(i));
+        return h;
+    }
+
+    std::uint64_t solution_t::hash_after(const move_t &m, std::uint64_t h) const {
+        if (m.kind == move_t::kind_t::swap) {
+            if (m.i == m.j) return h;
+            return h ^ position_hash(m.i, at(m.i)) ^ position_hash(m.j, at(m.j))
+                   ^ position_hash(m.i, at(m.j)) ^ position_hash(m.j, at(m.i));
+        }
+        for (int k = m.i; k <= m.j; k++)
+            h ^= position_hash(k, at(k)) ^ position_hash(k, at(m.i + m.j - k));
+        return h;
+    }
+
 
     std::ostream &operator<<(std::ostream &o, const solution_t v) {
         o << "{ ";
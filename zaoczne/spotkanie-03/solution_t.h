@@ -10,6 +10,7 @@
 #include <iostream>
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <numeric>
 #include <random>
@@ -22,18 +23,48 @@
 
 namespace mhe {
 
+    /**
+     * Elementary modification of the tour: swap of cities at positions i and j, or reversal
+     * of the segment [i, j] (i <= j), that is the 2-opt move.
+     */
+    struct move_t {
+        enum class kind_t {
+            swap, reverse
+        };
+        kind_t kind;
+        int i;
+        int j;
+    };
+
+    /**
+     * The tour as the order of cities. The solution only points to its problem, so copying it
+     * costs just the chromosome; the problem must outlive all of its solutions.
+     */
     class solution_t : public std::vector<int> {
     public:
-        std::shared_ptr<problem_t> problem;
+        const problem_t *problem = nullptr;
 
-        static solution_t for_problem(std::shared_ptr<problem_t> problem_) ;
+        static solution_t for_problem(const problem_t &problem_) ;
         double goal() const ;
         solution_t start_from_zero() const ;
         solution_t random_modify(std::mt19937 &rgen) const ;
         std::vector<solution_t> generate_neighbours() const ;
         solution_t best_neighbour() const ;
 
-        static solution_t random_solution(problem_t tsp_problem, std::mt19937 &rgen) ;
+        /// change of goal after applying the move, computed from the affected edges only
+        double delta(const move_t &m) const ;
+        /// modifies the solution in place
+        void apply(const move_t &m) ;
+        move_t random_move(std::mt19937 &rgen) const ;
+        std::vector<move_t> neighbour_moves() const ;
+        move_t best_move() const ;
+
+        /// position dependent hash of the tour (the same tour rotated gives different hash)
+        std::uint64_t hash() const ;
+        /// hash of the solution after the move, h must be the hash of the current solution
+        std::uint64_t hash_after(const move_t &m, std::uint64_t h) const ;
+
+        static solution_t random_solution(const problem_t &tsp_problem, std::mt19937 &rgen) ;
     };
 
 
@@ -0,0 +1,107 @@
+#ifndef MHE_STATIC_GA_T_H
+#define MHE_STATIC_GA_T_H
+
+#include "population_t.h"
+#include "solution_t.h"
+
+#include <algorithm>
+#include <concepts>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * What static_ga_t needs from the configuration of the problem.
+     *
+     * This is genetic_algorithm_config_t without virtual calls and without copies: the
+     * operators work in place on the rows of population_t, the selection only writes the
+     * indices of the parents. The probabilities of the operators are up to the configuration.
+     */
+    template<class config_t>
+    concept ga_config_c = requires(config_t &config, population_t &population, const population_t &const_population,
+                                   std::span<double> fitnesses, std::span<const double> const_fitnesses,
+                                   std::span<int> parents, std::span<const int> a, std::span<int> c,
+                                   std::mt19937 &rgen, int iteration) {
+        { config.population_size() } -> std::convertible_to<int>;
+        { config.termination_condition(iteration, const_fitnesses) } -> std::convertible_to<bool>;
+        config.initial_population(population, rgen);
+        config.evaluate_all(const_population, fitnesses);
+        config.selection(const_fitnesses, parents, rgen);
+        config.crossover(a, a, c, c, rgen);
+        config.mutation(c, rgen);
+    };
+
+    /**
+     * Generational genetic algorithm with the operators chosen at compile time.
+     *
+     * The configuration is a template parameter, so its operators are called directly and
+     * can be inlined into the generation loop. The offspring are written into the second
+     * of two preallocated populations, which then becomes the current one.
+     */
+    template<ga_config_c config_t>
+    class static_ga_t {
+    public:
+        static_ga_t(const problem_t &problem, config_t &config_) :
+                config(config_), current(problem, config_.population_size()),
+                next(problem, config_.population_size()), fitnesses(config_.population_size()),
+                parents(config_.population_size()), best(problem.size()) {
+        }
+
+        config_t &config;
+        /// print the average fitness every conv_curve generations, 0 means never
+        int conv_curve = 0;
+
+        /// the best solution found in all the generations
+        solution_t run(std::mt19937 &rgen) {
+            config.initial_population(current, rgen);
+            best_fitness = -std::numeric_limits<double>::infinity();
+            evaluate();
+            for (int iteration = 0; config.termination_condition(iteration, fitnesses); iteration++) {
+                config.selection(fitnesses, parents, rgen);
+                int i = 0;
+                for (; i + 1 < current.size(); i += 2)
+                    config.crossover(current[parents[i]], current[parents[i + 1]], next[i], next[i + 1], rgen);
+                if (i < current.size()) {
+                    auto a = current[parents[i]];
+                    std::copy(a.begin(), a.end(), next[i].begin());
+                }
+                for (i = 0; i < next.size(); i++) config.mutation(next[i], rgen);
+                std::swap(current, next);
+                evaluate();
+                if ((conv_curve > 0) && ((iteration % conv_curve) == 0)) {
+                    double average = std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0) / fitnesses.size();
+                    std::cout << iteration << " " << average << std::endl;
+                }
+            }
+            solution_t result;
+            result.assign(best.begin(), best.end());
+            result.problem = current.problem;
+            return result;
+        }
+
+    private:
+        void evaluate() {
+            config.evaluate_all(current, fitnesses);
+            for (int i = 0; i < current.size(); i++)
+                if (fitnesses[i] > best_fitness) {
+                    best_fitness = fitnesses[i];
+                    std::copy(current[i].begin(), current[i].end(), best.begin());
+                }
+        }
+
+        population_t current;
+        population_t next;
+        std::vector<double> fitnesses;
+        std::vector<int> parents;
+        std::vector<int> best;
+        double best_fitness;
+    };
+
+} // mhe
+
+#endif //MHE_STATIC_GA_T_H
@@ -0,0 +1,91 @@
+#include "steady_state_ga_t.h"
+#include "tsp_ga_config_t.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+namespace mhe {
+
+    steady_state_ga_t::steady_state_ga_t(const problem_t &problem, int population_size, double p_crossover_,
+                                         double p_mutation_, replacement_t replacement_) :
+            p_crossover(p_crossover_), p_mutation(p_mutation_), replacement(replacement_),
+            population(problem, population_size), children(problem, 2),
+            goals(population_size), children_goals(2), fitness_sum(0),
+            crossover(problem.size()),
+            best_tour(problem.size()), best_goal(std::numeric_limits<double>::infinity()) {
+    }
+
+    solution_t steady_state_ga_t::run(int iterations, std::mt19937 &rgen) {
+        tsp_ga_config_t::random_tours(population, rgen);
+        evaluate_all(population, goals);
+        worst.assign(goals);
+        best.assign(goals);
+        fitness_sum = 0;
+        for (auto g: goals) fitness_sum += 1.0 / (1 + g);
+        best_goal = goals[best.top()];
+        std::copy(population[best.top()].begin(), population[best.top()].end(), best_tour.begin());
+
+        const int steps = std::max(1, population.size() / 2);
+        std::uniform_real_distribution<double> distr(0.0, 1.0);
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            for (int step = 0; step < steps; step++) {
+                auto a = population[select(rgen)], b = population[select(rgen)];
+                auto c = children[0], d = children[1];
+                if (distr(rgen) > p_crossover) {
+                    crossover(crossover_kind, a, b, c, d, rgen);
+                } else {
+                    std::copy(a.begin(), a.end(), c.begin());
+                    std::copy(b.begin(), b.end(), d.begin());
+                }
+                if (distr(rgen) > p_mutation) tsp_ga_config_t::swap_neighbours(c, rgen);
+                if (distr(rgen) > p_mutation) tsp_ga_config_t::swap_neighbours(d, rgen);
+                evaluate_all(children, 0, 2, children_goals.data());
+                replace(victim(rgen), c, children_goals[0]);
+                replace(victim(rgen), d, children_goals[1]);
+            }
+            if ((conv_curve > 0) && ((iteration % conv_curve) == 0))
+                std::cout << iteration << " " << mean_fitness() << std::endl;
+        }
+        solution_t result;
+        result.assign(best_tour.begin(), best_tour.end());
+        result.problem = population.problem;
+        return result;
+    }
+
+    double steady_state_ga_t::min_fitness() const {
+        return 1.0 / (1 + goals[worst.top()]);
+    }
+
+    double steady_state_ga_t::max_fitness() const {
+        return 1.0 / (1 + goals[best.top()]);
+    }
+
+    double steady_state_ga_t::mean_fitness() const {
+        return fitness_sum / population.size();
+    }
+
+    int steady_state_ga_t::select(std::mt19937 &rgen) const {
+        return tsp_ga_config_t::tournament(population.size(), [this](int a, int b) { return goals[a] <= goals[b]; }, rgen);
+    }
+
+    int steady_state_ga_t::victim(std::mt19937 &rgen) const {
+        if (replacement == replacement_t::worst) return worst.top();
+        // the loser of the tournament, so the worse one wins it
+        return tsp_ga_config_t::tournament(population.size(), [this](int a, int b) { return goals[a] > goals[b]; }, rgen);
+    }
+
+    void steady_state_ga_t::replace(int i, std::span<const int> child, double goal) {
+        fitness_sum += 1.0 / (1 + goal) - 1.0 / (1 + goals[i]);
+        std::copy(child.begin(), child.end(), population[i].begin());
+        goals[i] = goal;
+        worst.update(i);
+        best.update(i);
+        if (goal < best_goal) {
+            best_goal = goal;
+            std::copy(child.begin(), child.end(), best_tour.begin());
+        }
+    }
+
+} // mhe
@@ -0,0 +1,68 @@
+#ifndef MHE_STEADY_STATE_GA_T_H
+#define MHE_STEADY_STATE_GA_T_H
+
+#include "crossover_t.h"
+#include "indexed_heap_t.h"
+#include "population_t.h"
+#include "solution_t.h"
+
+#include <random>
+#include <span>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Steady state genetic algorithm, the population is changed in place two children at a time.
+     *
+     * Every step picks two parents with tournaments, makes two children with PMX and the swap
+     * of neighbouring cities, and puts each child in place of the worst individual or of
+     * the loser of a tournament. The worst and the best individuals are kept in indexed heaps
+     * and the sum of the fitnesses is updated with every replacement, so the statistics of the
+     * population never need a pass over the whole population.
+     */
+    class steady_state_ga_t {
+    public:
+        enum class replacement_t {
+            worst, tournament
+        };
+
+        steady_state_ga_t(const problem_t &problem, int population_size, double p_crossover_,
+                          double p_mutation_, replacement_t replacement_ = replacement_t::worst);
+
+        double p_crossover;
+        double p_mutation;
+        replacement_t replacement;
+        crossover_t::kind_t crossover_kind = crossover_t::kind_t::pmx;
+        /// print the average fitness every conv_curve generations, 0 means never
+        int conv_curve = 0;
+
+        /// one iteration is a generation worth of steps, population size / 2 of them; returns the best solution found
+        solution_t run(int iterations, std::mt19937 &rgen);
+
+        double min_fitness() const;
+        double max_fitness() const;
+        double mean_fitness() const;
+
+    private:
+        int select(std::mt19937 &rgen) const;
+        int victim(std::mt19937 &rgen) const;
+        void replace(int i, std::span<const int> child, double goal);
+
+        population_t population;
+        population_t children;
+        std::vector<double> goals;
+        std::vector<double> children_goals;
+        /// the largest goal, so the worst individual, on the top
+        indexed_heap_t<std::less<double>> worst;
+        /// the smallest goal on the top
+        indexed_heap_t<std::greater<double>> best;
+        double fitness_sum;
+        crossover_t crossover;
+        std::vector<int> best_tour;
+        double best_goal;
+    };
+
+} // mhe
+
+#endif //MHE_STEADY_STATE_GA_T_H
@@ -0,0 +1,95 @@
+#include "thread_pool_t.h"
+
+#include <algorithm>
+
+namespace mhe {
+
+    thread_pool_t::thread_pool_t(int threads_) {
+        const int n = std::max(1, threads_);
+        for (int i = 0; i < n; i++) queues.push_back(std::make_unique<queue_t>());
+        for (int i = 1; i < n; i++) threads.emplace_back([this, i]() { worker(i); });
+    }
+
+    thread_pool_t::~thread_pool_t() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto &t: threads) t.join();
+    }
+
+    void thread_pool_t::parallel_for(int begin, int end, int grain, const std::function<void(int, int)> &f) {
+        grain = std::max(1, grain);
+        const int chunks = (std::max(0, end - begin) + grain - 1) / grain;
+        if ((chunks <= 1) || (size() == 1)) {
+            for (int first = begin; first < end; first += grain) f(first, std::min(end, first + grain));
+            return;
+        }
+        job = &f;
+        pending = chunks;
+        for (int q = 0; q < size(); q++) {
+            std::lock_guard<std::mutex> lock(queues[q]->mutex);
+            for (int c = chunks * q / size(); c < chunks * (q + 1) / size(); c++) {
+                int first = begin + c * grain;
+                queues[q]->chunks.push_back({first, std::min(end, first + grain)});
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            generation++;
+        }
+        wake.notify_all();
+        while (pending > 0) {
+            if (!run_one(0)) {
+                std::unique_lock<std::mutex> lock(wake_mutex);
+                done.wait(lock, [this]() { return pending == 0; });
+            }
+        }
+        job = nullptr;
+    }
+
+    void thread_pool_t::worker(int id) {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex);
+                wake.wait(lock, [&]() { return stop || (generation != seen); });
+                if (stop) return;
+                seen = generation;
+            }
+            while (run_one(id));
+        }
+    }
+
+    bool thread_pool_t::run_one(int id) {
+        chunk_t chunk;
+        bool found = false;
+        {
+            auto &own = *queues[id];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.chunks.empty()) {
+                chunk = own.chunks.back();
+                own.chunks.pop_back();
+                found = true;
+            }
+        }
+        for (int i = 1; (i < size()) && !found; i++) {
+            auto &victim = *queues[(id + i) % size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.chunks.empty()) {
+                chunk = victim.chunks.front();
+                victim.chunks.pop_front();
+                found = true;
+            }
+        }
+        if (!found) return false;
+        (*job)(chunk.first, chunk.last);
+        if (pending.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            done.notify_all();
+        }
+        return true;
+    }
+
+} // mhe
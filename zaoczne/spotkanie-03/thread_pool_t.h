@@ -0,0 +1,65 @@
+#ifndef MHE_THREAD_POOL_T_H
+#define MHE_THREAD_POOL_T_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Work-stealing pool for data parallel loops.
+     *
+     * parallel_for cuts the range into chunks and deals them out to the queues of the threads,
+     * neighbouring chunks to the same queue. Every thread takes chunks from the back of its own
+     * queue and, when it runs dry, steals from the front of the others. The calling thread works
+     * too, so a pool of n threads starts n - 1 new ones.
+     */
+    class thread_pool_t {
+    public:
+        explicit thread_pool_t(int threads = 1);
+        ~thread_pool_t();
+
+        thread_pool_t(const thread_pool_t &) = delete;
+        thread_pool_t &operator=(const thread_pool_t &) = delete;
+
+        int size() const { return queues.size(); }
+
+        /// calls f(first, last) for the chunks [first, last) of at most grain elements covering
+        /// [begin, end), returns when all of them are done
+        void parallel_for(int begin, int end, int grain, const std::function<void(int, int)> &f);
+
+    private:
+        struct chunk_t {
+            int first;
+            int last;
+        };
+        struct queue_t {
+            std::mutex mutex;
+            std::deque<chunk_t> chunks;
+        };
+
+        void worker(int id);
+        /// runs one chunk from the own queue or stolen from another one, false if there was none
+        bool run_one(int id);
+
+        std::vector<std::unique_ptr<queue_t>> queues;
+        std::vector<std::thread> threads;
+        const std::function<void(int, int)> *job = nullptr;
+        std::atomic<int> pending{0};
+        std::mutex wake_mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        std::uint64_t generation = 0;
+        bool stop = false;
+    };
+
+} // mhe
+
+#endif //MHE_THREAD_POOL_T_H
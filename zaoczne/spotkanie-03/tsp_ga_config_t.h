@@ -0,0 +1,103 @@
+#ifndef MHE_TSP_GA_CONFIG_T_H
+#define MHE_TSP_GA_CONFIG_T_H
+
+#include "crossover_t.h"
+#include "population_t.h"
+#include "problem_t.h"
+#include "static_ga_t.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * The TSP operators of the genetic algorithms, as the configuration of static_ga_t.
+     *
+     * Random tours at the start, tournament of two, one of the crossover_t crossovers and the
+     * swap of neighbouring cities as the mutation. tsp_config_t and steady_state_ga_t use the
+     * same static operators. Everything is in the header, so static_ga_t can inline it.
+     */
+    class tsp_ga_config_t {
+    public:
+        tsp_ga_config_t(const problem_t &problem_, int population_size_, int iterations_, double p_crossover_,
+                        double p_mutation_) :
+                problem(problem_), iterations(iterations_), p_crossover(p_crossover_), p_mutation(p_mutation_),
+                size(population_size_), crossover_op(problem_.size()) {
+        }
+
+        const problem_t &problem;
+        int iterations;
+        double p_crossover;
+        double p_mutation;
+        crossover_t::kind_t crossover_kind = crossover_t::kind_t::pmx;
+
+        int population_size() const { return size; }
+
+        bool termination_condition(int iteration, std::span<const double>) const { return iteration < iterations; }
+
+        void initial_population(population_t &population, std::mt19937 &rgen) { random_tours(population, rgen); }
+
+        void evaluate_all(const population_t &population, std::span<double> fitnesses) {
+            mhe::evaluate_all(population, goals);
+            for (int i = 0; i < population.size(); i++)
+                fitnesses[i] = 1.0 / (1 + goals[i]);
+        }
+
+        void selection(std::span<const double> fitnesses, std::span<int> parents, std::mt19937 &rgen) {
+            for (auto &p: parents)
+                p = tournament(fitnesses.size(), [&](int a, int b) { return fitnesses[a] >= fitnesses[b]; }, rgen);
+        }
+
+        void crossover(std::span<const int> a, std::span<const int> b, std::span<int> c, std::span<int> d,
+                       std::mt19937 &rgen) {
+            if (std::uniform_real_distribution<double>(0.0, 1.0)(rgen) > p_crossover) {
+                crossover_op(crossover_kind, a, b, c, d, rgen);
+            } else {
+                std::copy(a.begin(), a.end(), c.begin());
+                std::copy(b.begin(), b.end(), d.begin());
+            }
+        }
+
+        void mutation(std::span<int> s, std::mt19937 &rgen) {
+            if (std::uniform_real_distribution<double>(0.0, 1.0)(rgen) > p_mutation) swap_neighbours(s, rgen);
+        }
+
+        /// every row becomes a random permutation of the cities
+        static void random_tours(population_t &population, std::mt19937 &rgen) {
+            for (int i = 0; i < population.size(); i++) {
+                auto row = population[i];
+                std::iota(row.begin(), row.end(), 0);
+                std::shuffle(row.begin(), row.end(), rgen);
+            }
+        }
+
+        /// two random indices below size, the first one wins when better(first, second)
+        template<class better_t>
+        static int tournament(int size, better_t better, std::mt19937 &rgen) {
+            std::uniform_int_distribution<int> dist(0, size - 1);
+            int a_idx = dist(rgen);
+            int b_idx = dist(rgen);
+            return better(a_idx, b_idx) ? a_idx : b_idx;
+        }
+
+        /// swaps a random city with the next one on the tour
+        static void swap_neighbours(std::span<int> s, std::mt19937 &rgen) {
+            int a = std::uniform_int_distribution<int>(0, s.size() - 1)(rgen);
+            std::swap(s[a], s[(a + 1) % s.size()]);
+        }
+
+    private:
+        int size;
+        crossover_t crossover_op;
+        std::vector<double> goals;
+    };
+
+    static_assert(ga_config_c<tsp_ga_config_t>);
+
+} // mhe
+
+#endif //MHE_TSP_GA_CONFIG_T_H
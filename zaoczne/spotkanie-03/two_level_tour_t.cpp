@@ -0,0 +1,95 @@
+#include "two_level_tour_t.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace mhe {
+
+    two_level_tour_t::two_level_tour_t(const std::vector<int> &cities) :
+            segment_of(cities.size()), index(cities.size()) {
+        build(cities);
+    }
+
+    void two_level_tour_t::build(const std::vector<int> &cities) {
+        const int n = cities.size();
+        const int group = std::max(8, (int) std::sqrt((double) n));
+        segments.clear();
+        order.clear();
+        for (int start = 0; start < n; start += group) {
+            segment_t s{{cities.begin() + start, cities.begin() + std::min(n, start + group)}, false,
+                        (int) segments.size()};
+            for (int i = 0; i < (int) s.cities.size(); i++) {
+                segment_of[s.cities[i]] = segments.size();
+                index[s.cities[i]] = i;
+            }
+            order.push_back(segments.size());
+            segments.push_back(std::move(s));
+        }
+        max_segments = 2 * segments.size() + 8;
+    }
+
+    std::vector<int> two_level_tour_t::cities() const {
+        std::vector<int> result;
+        result.reserve(size());
+        for (int s: order) {
+            if (segments[s].reversed) result.insert(result.end(), segments[s].cities.rbegin(), segments[s].cities.rend());
+            else result.insert(result.end(), segments[s].cities.begin(), segments[s].cities.end());
+        }
+        return result;
+    }
+
+    void two_level_tour_t::normalize(int s) {
+        auto &seg = segments[s];
+        if (!seg.reversed) return;
+        std::reverse(seg.cities.begin(), seg.cities.end());
+        seg.reversed = false;
+        for (int i = 0; i < (int) seg.cities.size(); i++) index[seg.cities[i]] = i;
+    }
+
+    void two_level_tour_t::split_before(int c) {
+        int s = segment_of[c];
+        if (oriented_index(c) == 0) return;
+        normalize(s);
+        int rank = segments[s].rank;
+        segment_t tail{{segments[s].cities.begin() + index[c], segments[s].cities.end()}, false, rank + 1};
+        segments[s].cities.resize(index[c]);
+        int t = segments.size();
+        for (int i = 0; i < (int) tail.cities.size(); i++) {
+            segment_of[tail.cities[i]] = t;
+            index[tail.cities[i]] = i;
+        }
+        segments.push_back(std::move(tail));
+        order.insert(order.begin() + rank + 1, t);
+        for (int r = rank + 2; r < (int) order.size(); r++) segments[order[r]].rank = r;
+    }
+
+    void two_level_tour_t::reverse(int a, int b) {
+        if (a == b) return;
+        if ((segment_of[a] == segment_of[b]) && (oriented_index(a) < oriented_index(b))) {
+            // the path is inside one segment
+            auto &seg = segments[segment_of[a]];
+            int i = std::min(index[a], index[b]), j = std::max(index[a], index[b]);
+            std::reverse(seg.cities.begin() + i, seg.cities.begin() + j + 1);
+            for (int k = i; k <= j; k++) index[seg.cities[k]] = k;
+            return;
+        }
+        if ((int) order.size() + 2 > max_segments) build(cities());
+        split_before(a);
+        split_before(next(b));
+        const int m = order.size();
+        int first_rank = segments[segment_of[a]].rank;
+        int count = (segments[segment_of[b]].rank - first_rank + m) % m + 1;
+        if (count == m) return; // the whole tour, the cycle stays the same
+        if (2 * count > m) {
+            // reversing the rest of the tour gives the same cycle
+            first_rank = (first_rank + count) % m;
+            count = m - count;
+        }
+        for (int k = 0; k < count; k++) segments[order[(first_rank + k) % m]].reversed ^= true;
+        for (int k = 0; k < count / 2; k++)
+            std::swap(order[(first_rank + k) % m], order[(first_rank + count - 1 - k) % m]);
+        for (int k = 0; k < count; k++) segments[order[(first_rank + k) % m]].rank = (first_rank + k) % m;
+    }
+
+} // mhe
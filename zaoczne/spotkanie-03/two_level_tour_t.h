@@ -0,0 +1,95 @@
+#ifndef MHE_TWO_LEVEL_TOUR_T_H
+#define MHE_TWO_LEVEL_TOUR_T_H
+
+#include <cstdint>
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * Tour split into about sqrt(n) segments, for local search on very large instances.
+     *
+     * Every segment is a small array of cities with the reversed bit, the segments are kept in the
+     * order array. next, prev and between are O(1). reverse splits the segments at the ends of the
+     * path and then reverses the order of whole segments (and flips their bits), so it costs
+     * O(sqrt(n)) instead of O(n). The splits make the segments smaller, so from time to time
+     * the segments are rebuilt.
+     *
+     * The interface is the same as the one of array_tour_t, so the local search engines work on both.
+     */
+    class two_level_tour_t {
+    public:
+        /// from this size on the local search is faster on this tour than on array_tour_t
+        static constexpr int preferred_size = 20000;
+
+        explicit two_level_tour_t(const std::vector<int> &cities);
+
+        int size() const { return segment_of.size(); }
+
+        int next(int c) const {
+            auto &s = segments[segment_of[c]];
+            int i = index[c];
+            if (!s.reversed && (i + 1 < (int) s.cities.size())) return s.cities[i + 1];
+            if (s.reversed && (i > 0)) return s.cities[i - 1];
+            return first(order[(s.rank + 1 == (int) order.size()) ? 0 : s.rank + 1]);
+        }
+
+        int prev(int c) const {
+            auto &s = segments[segment_of[c]];
+            int i = index[c];
+            if (!s.reversed && (i > 0)) return s.cities[i - 1];
+            if (s.reversed && (i + 1 < (int) s.cities.size())) return s.cities[i + 1];
+            return last(order[(s.rank == 0) ? order.size() - 1 : s.rank - 1]);
+        }
+
+        /// true if b lies on the path going forward from a to c (inclusive)
+        bool between(int a, int b, int c) const {
+            auto ka = key(a), kb = key(b), kc = key(c);
+            if (ka <= kc) return (ka <= kb) && (kb <= kc);
+            return (kb >= ka) || (kb <= kc);
+        }
+
+        /// reverses the path going forward from a to b
+        void reverse(int a, int b);
+
+        std::vector<int> cities() const;
+
+    private:
+        struct segment_t {
+            std::vector<int> cities;
+            bool reversed;
+            int rank;
+        };
+
+        int first(int s) const { return segments[s].reversed ? segments[s].cities.back() : segments[s].cities.front(); }
+
+        int last(int s) const { return segments[s].reversed ? segments[s].cities.front() : segments[s].cities.back(); }
+
+        /// index of the city in the forward direction of its segment
+        int oriented_index(int c) const {
+            auto &s = segments[segment_of[c]];
+            return s.reversed ? s.cities.size() - 1 - index[c] : index[c];
+        }
+
+        std::int64_t key(int c) const {
+            return (std::int64_t(segments[segment_of[c]].rank) << 32) + oriented_index(c);
+        }
+
+        void build(const std::vector<int> &cities);
+
+        /// stores the cities of the segment in the forward direction
+        void normalize(int s);
+
+        /// makes c the first city of its segment
+        void split_before(int c);
+
+        std::vector<segment_t> segments;
+        std::vector<int> order;      ///< segments in the tour order, segment_t::rank is the position here
+        std::vector<int> segment_of;
+        std::vector<int> index;      ///< index of the city in segment_t::cities
+        int max_segments = 0;
+    };
+
+} // mhe
+
+#endif //MHE_TWO_LEVEL_TOUR_T_H
@@ -0,0 +1,87 @@
+#include "two_opt_t.h"
+
+namespace mhe {
+
+    namespace {
+        constexpr double epsilon = 1e-10;
+    }
+
+    two_opt_t::two_opt_t(const problem_t &problem_, int k) : problem(problem_), candidates(problem_, k) {
+    }
+
+    void two_opt_t::activate(int city) {
+        if (queued[city]) return;
+        queued[city] = 1;
+        queue.push_back(city);
+    }
+
+    template<class tour_t>
+    double two_opt_t::improve(tour_t &tour) {
+        queued.assign(tour.size(), 0);
+        gain = 0.0;
+        // the don't-look bits can miss a move whose candidate city got new tour neighbours, so
+        // the sweep repeats with all the cities active until it finds nothing
+        for (double pass_start = -1.0; gain > pass_start;) {
+            pass_start = gain;
+            queue.clear();
+            queue_head = 0;
+            for (int c: tour.cities()) activate(c);
+            while (queue_head < queue.size()) {
+                int a = queue[queue_head++];
+                // compact the queue from time to time, so it does not grow without bounds
+                if (queue_head > 4096 && 2 * queue_head > queue.size()) {
+                    queue.erase(queue.begin(), queue.begin() + queue_head);
+                    queue_head = 0;
+                }
+                queued[a] = 0;
+                if (improve_city(tour, a)) activate(a);
+            }
+        }
+        return gain;
+    }
+
+    solution_t two_opt_t::improve(solution_t solution) {
+        auto optimize = [&](auto tour) {
+            improve(tour);
+            auto cities = tour.cities();
+            std::copy(cities.begin(), cities.end(), solution.begin());
+        };
+        if (solution.size() >= two_level_tour_t::preferred_size) optimize(two_level_tour_t(solution));
+        else optimize(array_tour_t(solution));
+        return solution;
+    }
+
+    template<class tour_t>
+    bool two_opt_t::improve_city(tour_t &tour, int a) {
+        auto neighbours = candidates[a];
+        auto neighbour_distances = candidates.distances(a);
+        for (bool forward: {true, false}) {
+            int b = forward ? tour.next(a) : tour.prev(a);
+            double d_ab = problem.distance(a, b);
+            for (std::size_t i = 0; i < neighbours.size(); i++) {
+                int c = neighbours[i];
+                double d_ac = neighbour_distances[i];
+                if (d_ac >= d_ab) break;
+                int d = forward ? tour.next(c) : tour.prev(c);
+                if ((c == b) || (d == a)) continue;
+                double delta = d_ac + problem.distance(b, d) - d_ab - problem.distance(c, d);
+                if (delta < -epsilon) {
+                    // forward: a b ... c d -> a c ... b d, backward: d c ... b a -> d b ... c a
+                    if (forward) tour.reverse(b, c);
+                    else tour.reverse(c, b);
+                    gain -= delta;
+                    activate(b);
+                    activate(c);
+                    activate(d);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    template double two_opt_t::improve<array_tour_t>(array_tour_t &tour);
+
+    template double two_opt_t::improve<two_level_tour_t>(two_level_tour_t &tour);
+
+} // mhe
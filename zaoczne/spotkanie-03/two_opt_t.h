@@ -0,0 +1,50 @@
+#ifndef MHE_TWO_OPT_T_H
+#define MHE_TWO_OPT_T_H
+
+#include "array_tour_t.h"
+#include "candidate_lists_t.h"
+#include "solution_t.h"
+#include "two_level_tour_t.h"
+
+#include <vector>
+
+namespace mhe {
+
+    /**
+     * 2-opt local search driven by the candidate lists.
+     *
+     * For a city a with a tour neighbour b only the edges (a, c) with d(a, c) < d(a, b) are tried,
+     * c taken from the candidate list of a. Cities wait for processing in the queue and every city
+     * that had no improving move gets its don't-look bit set (it simply leaves the queue). The
+     * endpoints of every applied move go back to the queue. The result is a local optimum with
+     * respect to the candidate lists.
+     */
+    class two_opt_t {
+    public:
+        explicit two_opt_t(const problem_t &problem, int k = 8);
+
+        /// improves the tour until no improving move is found, returns the decrease of the tour length;
+        /// available for array_tour_t and two_level_tour_t
+        template<class tour_t>
+        double improve(tour_t &tour);
+
+        /// works on two_level_tour_t for large instances and on array_tour_t otherwise
+        solution_t improve(solution_t solution);
+
+    private:
+        template<class tour_t>
+        bool improve_city(tour_t &tour, int a);
+
+        void activate(int city);
+
+        const problem_t &problem;
+        candidate_lists_t candidates;
+        std::vector<int> queue;
+        std::vector<char> queued;
+        std::size_t queue_head = 0;
+        double gain = 0.0;
+    };
+
+} // mhe
+
+#endif //MHE_TWO_OPT_T_H